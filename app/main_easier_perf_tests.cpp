@@ -6,6 +6,7 @@
 #include "Windows.h"
 #include <iostream>
 #include <profileapi.h>
+#include <psapi.h>
 #include <random>
 #include <winnt.h>
 
@@ -19,6 +20,10 @@
 // 3. Iterate over N number of entities and get 2 components from that entity.
 // 4. Iterate over N number of entities and get 3 components from that entity.
 // 5. Iterate over N number of entities and get 4 components from that entity.
+// 6. Create N number of entities with 4 components while 1, 10 and 100 systems are registered.
+// 7. Update 8 independent systems one after the other and then with the parallel scheduler.
+// 8. The overhead of spawning, stealing and waiting on jobs in the job system.
+// 9. Create and destroy N number of entities from one thread and then from every thread.
 
 // There are plenty more tests that could be be done:
 //  - Insertion time
@@ -47,6 +52,19 @@ int roll(int min, int max)
   return uni(rng);
 }
 
+/**
+ * @brief Print the current working set (resident memory) of the process.
+ *
+ * @param label A label to print alongside the memory usage
+ */
+void PrintMemoryUsage(const std::string& label)
+{
+  PROCESS_MEMORY_COUNTERS counters;
+  if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+    std::cout << label << " - Working Set: " << counters.WorkingSetSize / 1024 << " KB\n";
+  }
+}
+
 }// namespace
 
 /**
@@ -148,7 +166,7 @@ public:
   void Iterate4Components()
   {
     auto& entities = GetEntities();
-    for (auto& entity : entities) {
+    for (const auto& entity : entities) {
       auto animal_component = entity.GetComponent<Animals>();
       auto animal_food_component = entity.GetComponent<AnimalFood>();
       auto animal_hair_component = entity.GetComponent<AnimalHairStyle>();
@@ -169,7 +187,7 @@ public:
   void Iterate3Components()
   {
     auto& entities = GetEntities();
-    for (auto& entity : entities) {
+    for (const auto& entity : entities) {
       auto animal_component = entity.GetComponent<Animals>();
       auto animal_food_component = entity.GetComponent<AnimalFood>();
       auto animal_hair_component = entity.GetComponent<AnimalHairStyle>();
@@ -188,7 +206,7 @@ public:
   void Iterate2Components()
   {
     auto& entities = GetEntities();
-    for (auto& entity : entities) {
+    for (const auto& entity : entities) {
       auto animal_component = entity.GetComponent<Animals>();
       auto animal_food_component = entity.GetComponent<AnimalFood>();
       animal_component->cat[0][1] = 1.0;
@@ -203,7 +221,7 @@ public:
   void Iterate()
   {
     auto& entities = GetEntities();
-    for (auto& entity : entities) {
+    for (const auto& entity : entities) {
       auto animal_component = entity.GetComponent<Animals>();
       animal_component->cat[0][1] = 1.0;
       animal_component->dog[2][2] = 1.0;
@@ -211,9 +229,163 @@ public:
     }
   }
 
+  // The IterateView functions below resolve the component arrays once through a View instead of looking up each
+  // component per entity. They work with both sparse and archetype storage.
+  void IterateView4Components()
+  {
+    GetView<Animals, AnimalFood, AnimalHairStyle, AnimalHabitat>()->Each(
+      [](EntityID,
+        Animals& animal_component,
+        AnimalFood& animal_food_component,
+        AnimalHairStyle& animal_hair_component,
+        AnimalHabitat& animal_habitat_component) {
+        animal_component.cat[0][1] = 1.0;
+        animal_component.dog[2][2] = 1.0;
+        animal_component.fish[3][3] = animal_component.dog[2][2] + 2.0f;
+        animal_food_component.cat_food = 1.0;
+        animal_food_component.dog_food = 2.0;
+        animal_food_component.fish_food = 3.0;
+        animal_hair_component.bald = 1.0;
+        animal_hair_component.curly = 2.0;
+        animal_hair_component.mohawk = 3.0;
+        animal_habitat_component.habitat = 540.0;
+      });
+  }
+
+  // The same as IterateView4Components() but with the entities split over the ECS thread pool.
+  void ParallelIterateView4Components()
+  {
+    GetView<Animals, AnimalFood, AnimalHairStyle, AnimalHabitat>()->ParallelEach(GetJobSystem(),
+      [](EntityID,
+        Animals& animal_component,
+        AnimalFood& animal_food_component,
+        AnimalHairStyle& animal_hair_component,
+        AnimalHabitat& animal_habitat_component) {
+        animal_component.cat[0][1] = 1.0;
+        animal_component.dog[2][2] = 1.0;
+        animal_component.fish[3][3] = animal_component.dog[2][2] + 2.0f;
+        animal_food_component.cat_food = 1.0;
+        animal_food_component.dog_food = 2.0;
+        animal_food_component.fish_food = 3.0;
+        animal_hair_component.bald = 1.0;
+        animal_hair_component.curly = 2.0;
+        animal_hair_component.mohawk = 3.0;
+        animal_habitat_component.habitat = 540.0;
+      });
+  }
+
+  void IterateView3Components()
+  {
+    GetView<Animals, AnimalFood, AnimalHairStyle>()->Each(
+      [](EntityID, Animals& animal_component, AnimalFood& animal_food_component, AnimalHairStyle& animal_hair_component) {
+        animal_component.cat[0][1] = 1.0;
+        animal_component.dog[2][2] = 1.0;
+        animal_component.fish[3][3] = animal_component.dog[2][2] + 2.0f;
+        animal_food_component.cat_food = 1.0;
+        animal_food_component.dog_food = 2.0;
+        animal_food_component.fish_food = 3.0;
+        animal_hair_component.bald = 1.0;
+        animal_hair_component.curly = 2.0;
+        animal_hair_component.mohawk = 3.0;
+      });
+  }
+
+  void IterateView2Components()
+  {
+    GetView<Animals, AnimalFood>()->Each(
+      [](EntityID, Animals& animal_component, AnimalFood& animal_food_component) {
+        animal_component.cat[0][1] = 1.0;
+        animal_component.dog[2][2] = 1.0;
+        animal_component.fish[3][3] = animal_component.dog[2][2] + 2.0f;
+        animal_food_component.cat_food = 1.0;
+        animal_food_component.dog_food = 2.0;
+        animal_food_component.fish_food = 3.0;
+      });
+  }
+
   void Update(const float& delta_time) override { std::ignore = delta_time; }
 };
 
+// A component and system per index for the parallel scheduling test. Each system only touches its own component so
+// every system can run at the same time.
+template<int Index> struct IndependentComponent
+{
+  float values[16]{};
+};
+
+template<int Index> class IndependentSystem : public System
+{
+public:
+  void Update(const float& delta_time) override
+  {
+    GetView<IndependentComponent<Index>>()->Each([delta_time](EntityID, IndependentComponent<Index>& component) {
+      for (auto& value : component.values) {
+        value = value * 0.5f + delta_time;
+      }
+    });
+  }
+};
+
+// Register the four animal components and system_count systems spread over a few different signatures.
+void SetUpConstructionECS(ECSController& construction_ecs, int system_count)
+{
+  if (construction_ecs.RegisterComponent<Animals>().Bad() || construction_ecs.RegisterComponent<AnimalFood>().Bad()
+      || construction_ecs.RegisterComponent<AnimalHabitat>().Bad()
+      || construction_ecs.RegisterComponent<AnimalHairStyle>().Bad()) {
+    printf("Failed to register construction components");
+    std::terminate();
+  }
+  SystemSignature signatures[4];
+  signatures[0].SetComponent<Animals>();
+  signatures[1].SetComponent<Animals, AnimalFood>();
+  signatures[2].SetComponent<AnimalHabitat, AnimalHairStyle>();
+  signatures[3].SetComponent<Animals, AnimalFood, AnimalHabitat, AnimalHairStyle>();
+  for (int i = 0; i < system_count; ++i) {
+    std::ignore = construction_ecs.RegisterSystem<MyAnimalSystem>(signatures[i % 4]);
+  }
+}
+
+template<int... Indices>
+void RunIndependentSystemsTest(int entity_count, int iteration_count, std::integer_sequence<int, Indices...>)
+{
+  ECSController parallel_ecs;
+  if ((parallel_ecs.RegisterComponent<IndependentComponent<Indices>>().Bad() || ...)) {
+    printf("Failed to register independent components");
+    std::terminate();
+  }
+  std::vector<System*> systems;
+  (
+    [&] {
+      SystemSignature signature;
+      signature.SetComponent<IndependentComponent<Indices>>();
+      systems.push_back(&parallel_ecs.GetSystem(parallel_ecs.RegisterSystem<IndependentSystem<Indices>>(signature)));
+    }(),
+    ...);
+  for (int i = 0; i < entity_count; ++i) {
+    Result<Entity> entity = parallel_ecs.CreateEntity();
+    if (entity.Bad() || (entity->AddComponent<IndependentComponent<Indices>>().Bad() || ...)) {
+      printf("Failed to create independent entity");
+      std::terminate();
+    }
+  }
+  Timer serial_timer("Our ECS (Serial)");
+  for (int i = 0; i < iteration_count; ++i) {
+    serial_timer.Start();
+    for (auto* system : systems) {
+      system->UpdateSystem(1.0f);
+    }
+    serial_timer.CaptureTimePoint(false);
+  }
+  serial_timer.PrintAverageTime();
+  Timer parallel_timer("Our ECS (Parallel scheduler)");
+  for (int i = 0; i < iteration_count; ++i) {
+    parallel_timer.Start();
+    parallel_ecs.UpdateSystems(1.0f);
+    parallel_timer.CaptureTimePoint(false);
+  }
+  parallel_timer.PrintAverageTime();
+}
+
 int main(int argc, const char** argv)
 {
   // ---- Test Constants ----
@@ -228,13 +400,13 @@ int main(int argc, const char** argv)
   // Register components
   auto err = ecs_controller.RegisterComponent<Animals>();
   if (err) {
-    auto err = ecs_controller.RegisterComponent<AnimalFood>();
+    err = ecs_controller.RegisterComponent<AnimalFood>();
   }
   if (err) {
-    auto err = ecs_controller.RegisterComponent<AnimalHabitat>();
+    err = ecs_controller.RegisterComponent<AnimalHabitat>();
   }
   if (err) {
-    auto err = ecs_controller.RegisterComponent<AnimalHairStyle>();
+    err = ecs_controller.RegisterComponent<AnimalHairStyle>();
   }
 
   if (err) {
@@ -246,6 +418,7 @@ int main(int argc, const char** argv)
     auto animal_system_id = ecs_controller.RegisterSystem<MyAnimalSystem>(animal_system_signature);
 
 
+
     // !!!!!!!!!!!!!!!!!!!!!!!!!!! TEST 1 BEGIN !!!!!!!!!!!!!!!!!!!!!!!!!!!
     printf("\n-------------------------------------------------------------\n");
     printf("Iterating over N number of entities with 1 specific component");
@@ -282,6 +455,30 @@ int main(int argc, const char** argv)
       }
       entities.push_back(*entity);
     }
+    PrintMemoryUsage("Our ECS after creating entities");
+
+    // Create the same entities in an ECS using archetype storage
+    ECSController archetype_ecs_controller(StorageMode::Archetype);
+    if (archetype_ecs_controller.RegisterComponent<Animals>().Bad()
+        || archetype_ecs_controller.RegisterComponent<AnimalFood>().Bad()
+        || archetype_ecs_controller.RegisterComponent<AnimalHabitat>().Bad()
+        || archetype_ecs_controller.RegisterComponent<AnimalHairStyle>().Bad()) {
+      printf("Failed to register archetype components");
+      std::terminate();
+    }
+    auto archetype_animal_system_id =
+      archetype_ecs_controller.RegisterSystem<MyAnimalSystem>(animal_system_signature);
+    std::vector<Entity> archetype_entities;
+    for (int i = 0; i < entity_count; ++i) {
+      Result<Entity> entity = archetype_ecs_controller.CreateEntity();
+      if (entity.Bad() || entity->AddComponent<Animals>().Bad() || entity->AddComponent<AnimalFood>().Bad()
+          || entity->AddComponent<AnimalHabitat>().Bad() || entity->AddComponent<AnimalHairStyle>().Bad()) {
+        printf("Failed to create archetype entity");
+        std::terminate();
+      }
+      archetype_entities.push_back(*entity);
+    }
+    auto& archetype_animal_system = archetype_ecs_controller.GetSystem(archetype_animal_system_id);
 
     // Get the AnimalSystem, create a timer and time each iteration of the system entities.
     auto& animal_system = ecs_controller.GetSystem(animal_system_id);
@@ -298,11 +495,8 @@ int main(int argc, const char** argv)
     std::vector<AnimalCollectorEntity*> animal_collectors;
     for (size_t i = 0; i < entity_count; ++i) {
       EntityID id{ i };
-      animal_collectors.emplace_back(new AnimalCollectorEntity{ id });
-      animal_collectors.back()->animal_component = Animals{};
-      animal_collectors.back()->animal_food_component = AnimalFood{};
-      animal_collectors.back()->animal_habitat_component = AnimalHabitat{};
-      animal_collectors.back()->animal_hair_style_component = AnimalHairStyle{};
+      animal_collectors.emplace_back(
+        new AnimalCollectorEntity{ id, Animals{}, AnimalFood{}, AnimalHabitat{}, AnimalHairStyle{} });
     }
 
     Timer timer_3("Vector of Entity pointers");
@@ -366,6 +560,7 @@ int main(int argc, const char** argv)
       if (num <= 6) {
         // Destroy our entities
         entities[i].Destroy();
+        archetype_entities[i].Destroy();
         // Destroy EnTT entities
         registry.destroy(static_cast<entt::entity>(i));
         // Delete pointer entity
@@ -434,6 +629,22 @@ int main(int argc, const char** argv)
       timer_8.CaptureTimePoint(false);
     }
     timer_8.PrintAverageTime();
+
+    Timer timer_8_view("Our ECS (View)");
+    for (int i = 0; i < iteration_count; i++) {
+      timer_8_view.Start();
+      animal_system.IterateView2Components();
+      timer_8_view.CaptureTimePoint(false);
+    }
+    timer_8_view.PrintAverageTime();
+
+    Timer timer_8_archetype("Our ECS (Archetype)");
+    for (int i = 0; i < iteration_count; i++) {
+      timer_8_archetype.Start();
+      archetype_animal_system.IterateView2Components();
+      timer_8_archetype.CaptureTimePoint(false);
+    }
+    timer_8_archetype.PrintAverageTime();
     // !======== Our ECS ========!
 
     // ========= Vector of Entity pointers =========
@@ -495,6 +706,22 @@ int main(int argc, const char** argv)
       timer_11.CaptureTimePoint(false);
     }
     timer_11.PrintAverageTime();
+
+    Timer timer_11_view("Our ECS (View)");
+    for (int i = 0; i < iteration_count; i++) {
+      timer_11_view.Start();
+      animal_system.IterateView3Components();
+      timer_11_view.CaptureTimePoint(false);
+    }
+    timer_11_view.PrintAverageTime();
+
+    Timer timer_11_archetype("Our ECS (Archetype)");
+    for (int i = 0; i < iteration_count; i++) {
+      timer_11_archetype.Start();
+      archetype_animal_system.IterateView3Components();
+      timer_11_archetype.CaptureTimePoint(false);
+    }
+    timer_11_archetype.PrintAverageTime();
     // !======== Our ECS ========!
 
     // ========= Vector of Entity pointers =========
@@ -566,6 +793,78 @@ int main(int argc, const char** argv)
       timer_14.CaptureTimePoint(false);
     }
     timer_14.PrintAverageTime();
+
+    Timer timer_14_view("Our ECS (View)");
+    for (int i = 0; i < iteration_count; i++) {
+      timer_14_view.Start();
+      animal_system.IterateView4Components();
+      timer_14_view.CaptureTimePoint(false);
+    }
+    timer_14_view.PrintAverageTime();
+
+    Timer timer_14_parallel("Our ECS (View ParallelEach)");
+    for (int i = 0; i < iteration_count; i++) {
+      timer_14_parallel.Start();
+      animal_system.ParallelIterateView4Components();
+      timer_14_parallel.CaptureTimePoint(false);
+    }
+    timer_14_parallel.PrintAverageTime();
+
+    // An owning group keeps all four component arrays co-sorted. It lives in its own ECS so the other tests don't pay
+    // for the group swaps on every create, add, remove and destroy.
+    ECSController group_ecs_controller;
+    if (group_ecs_controller.RegisterComponent<Animals>().Bad()
+        || group_ecs_controller.RegisterComponent<AnimalFood>().Bad()
+        || group_ecs_controller.RegisterComponent<AnimalHabitat>().Bad()
+        || group_ecs_controller.RegisterComponent<AnimalHairStyle>().Bad()) {
+      printf("Failed to register group components");
+      std::terminate();
+    }
+    auto animal_group = group_ecs_controller.RegisterGroup<Animals, AnimalFood, AnimalHairStyle, AnimalHabitat>();
+    if (animal_group.Bad()) {
+      printf("%s", animal_group.Error().Message());
+      std::terminate();
+    }
+    for (int i = 0; i < entity_count; ++i) {
+      Result<Entity> entity = group_ecs_controller.CreateEntity();
+      if (entity.Bad() || entity->AddComponent<Animals>().Bad() || entity->AddComponent<AnimalFood>().Bad()
+          || entity->AddComponent<AnimalHabitat>().Bad() || entity->AddComponent<AnimalHairStyle>().Bad()) {
+        printf("Failed to create group entity");
+        std::terminate();
+      }
+    }
+
+    Timer timer_14_group("Our ECS (Group)");
+    for (int i = 0; i < iteration_count; i++) {
+      timer_14_group.Start();
+      (*animal_group)
+        ->Each([](EntityID,
+                 Animals& animal_component,
+                 AnimalFood& animal_food_component,
+                 AnimalHairStyle& animal_hair_component,
+                 AnimalHabitat& animal_habitat_component) {
+          animal_component.cat[0][1] = 1.0;
+          animal_component.dog[2][2] = 1.0;
+          animal_component.fish[3][3] = animal_component.dog[2][2] + 2.0f;
+          animal_food_component.cat_food = 1.0;
+          animal_food_component.dog_food = 2.0;
+          animal_food_component.fish_food = 3.0;
+          animal_hair_component.bald = 1.0;
+          animal_hair_component.curly = 2.0;
+          animal_hair_component.mohawk = 3.0;
+          animal_habitat_component.habitat = 540.0;
+        });
+      timer_14_group.CaptureTimePoint(false);
+    }
+    timer_14_group.PrintAverageTime();
+
+    Timer timer_14_archetype("Our ECS (Archetype)");
+    for (int i = 0; i < iteration_count; i++) {
+      timer_14_archetype.Start();
+      archetype_animal_system.IterateView4Components();
+      timer_14_archetype.CaptureTimePoint(false);
+    }
+    timer_14_archetype.PrintAverageTime();
     // !======== Our ECS ========!
 
     // ========= Vector of Entity pointers =========
@@ -630,6 +929,138 @@ int main(int argc, const char** argv)
     // !======= EnTT =======!
     // !!!!!!!!!!!!!!!!!!!!!!!!!!! TEST 5 END !!!!!!!!!!!!!!!!!!!!!!!!!!!
 
+    // !!!!!!!!!!!!!!!!!!!!!!!!!!! TEST 6 BEGIN !!!!!!!!!!!!!!!!!!!!!!!!!!!
+    printf("\n----------------------------------------------------------------------------\n");
+    printf("Create N number of entities with 4 components while 1, 10 and 100 systems exist");
+    printf("\n----------------------------------------------------------------------------\n");
+    for (int system_count : { 1, 10, 100 }) {
+      ECSController construction_ecs;
+      SetUpConstructionECS(construction_ecs, system_count);
+      Timer construction_timer("Our ECS (" + std::to_string(system_count) + " systems)");
+      construction_timer.Start();
+      for (int i = 0; i < entity_count; ++i) {
+        Result<Entity> entity = construction_ecs.CreateEntity();
+        if (entity.Bad() || entity->AddComponent<Animals>().Bad() || entity->AddComponent<AnimalFood>().Bad()
+            || entity->AddComponent<AnimalHabitat>().Bad() || entity->AddComponent<AnimalHairStyle>().Bad()) {
+          printf("Failed to create construction entity");
+          std::terminate();
+        }
+      }
+      construction_timer.CaptureTimePoint(false);
+      construction_timer.PrintAverageTime();
+    }
+    // !!!!!!!!!!!!!!!!!!!!!!!!!!! TEST 6 END !!!!!!!!!!!!!!!!!!!!!!!!!!!
+
+    // !!!!!!!!!!!!!!!!!!!!!!!!!!! TEST 7 BEGIN !!!!!!!!!!!!!!!!!!!!!!!!!!!
+    printf("\n----------------------------------------------------------------------------\n");
+    printf("Update 8 independent systems over N number of entities, serially and in parallel");
+    printf("\n----------------------------------------------------------------------------\n");
+    RunIndependentSystemsTest(entity_count, 1000, std::make_integer_sequence<int, 8>{});
+    // !!!!!!!!!!!!!!!!!!!!!!!!!!! TEST 7 END !!!!!!!!!!!!!!!!!!!!!!!!!!!
+
+    // !!!!!!!!!!!!!!!!!!!!!!!!!!! TEST 8 BEGIN !!!!!!!!!!!!!!!!!!!!!!!!!!!
+    printf("\n----------------------------------------------------------------------------\n");
+    printf("Spawn and wait on N number of empty jobs");
+    printf("\n----------------------------------------------------------------------------\n");
+    JobSystem& job_system = ecs_controller.GetJobSystem();
+    Timer spawn_timer("Job system (Spawn from one thread)");
+    for (int i = 0; i < 100; i++) {
+      spawn_timer.Start();
+      JobCounter counter;
+      for (int j = 0; j < entity_count; ++j) {
+        job_system.Spawn([] {}, &counter);
+      }
+      job_system.WaitHelping(counter);
+      spawn_timer.CaptureTimePoint(false);
+    }
+    spawn_timer.PrintAverageTime();
+    // Every thread spawning its own jobs, so most jobs run where they were spawned and the rest are stolen.
+    Timer nested_timer("Job system (Spawn from every thread)");
+    for (int i = 0; i < 100; i++) {
+      nested_timer.Start();
+      const size_t per_thread = entity_count / job_system.ThreadCount();
+      job_system.ParallelFor(job_system.ThreadCount(), [&job_system, per_thread](size_t) {
+        JobCounter counter;
+        for (size_t j = 0; j < per_thread; ++j) {
+          job_system.Spawn([] {}, &counter);
+        }
+        job_system.WaitHelping(counter);
+      });
+      nested_timer.CaptureTimePoint(false);
+    }
+    nested_timer.PrintAverageTime();
+    // !!!!!!!!!!!!!!!!!!!!!!!!!!! TEST 8 END !!!!!!!!!!!!!!!!!!!!!!!!!!!
+
+    // !!!!!!!!!!!!!!!!!!!!!!!!!!! TEST 9 BEGIN !!!!!!!!!!!!!!!!!!!!!!!!!!!
+    printf("\n----------------------------------------------------------------------------\n");
+    printf("Create and destroy N number of entities from one thread and from every thread");
+    printf("\n----------------------------------------------------------------------------\n");
+    EntityManager concurrent_entity_manager;
+    std::vector<EntityID> created_ids(entity_count, EntityID{ 0 });
+    Timer single_create_timer("EntityManager (1 thread)");
+    for (int i = 0; i < 100; i++) {
+      single_create_timer.Start();
+      for (auto& entity_id : created_ids) {
+        entity_id = *concurrent_entity_manager.CreateEntity();
+      }
+      for (const auto& entity_id : created_ids) {
+        concurrent_entity_manager.DestroyEntity(entity_id);
+      }
+      single_create_timer.CaptureTimePoint(false);
+    }
+    single_create_timer.PrintAverageTime();
+    Timer parallel_create_timer("EntityManager (" + std::to_string(job_system.ThreadCount()) + " threads)");
+    for (int i = 0; i < 100; i++) {
+      parallel_create_timer.Start();
+      job_system.ParallelForChunks(created_ids.size(), 256, [&](size_t begin, size_t end) {
+        for (size_t index = begin; index < end; ++index) {
+          created_ids[index] = *concurrent_entity_manager.CreateEntity();
+        }
+        for (size_t index = begin; index < end; ++index) {
+          concurrent_entity_manager.DestroyEntity(created_ids[index]);
+        }
+      });
+      parallel_create_timer.CaptureTimePoint(false);
+    }
+    parallel_create_timer.PrintAverageTime();
+    // !!!!!!!!!!!!!!!!!!!!!!!!!!! TEST 9 END !!!!!!!!!!!!!!!!!!!!!!!!!!!
+
+    // !!!!!!!!!!!!!!!!!!!!!!!!!!! TEST 10 BEGIN !!!!!!!!!!!!!!!!!!!!!!!!!!!
+    printf("\n----------------------------------------------------------------------------\n");
+    printf("Create N number of entities with 4 components in batches while 1, 10 and 100 systems exist");
+    printf("\n----------------------------------------------------------------------------\n");
+    for (int system_count : { 1, 10, 100 }) {
+      ECSController batch_ecs;
+      SetUpConstructionECS(batch_ecs, system_count);
+      Timer batch_timer("Our ECS CreateEntities (" + std::to_string(system_count) + " systems)");
+      batch_timer.Start();
+      auto entities =
+        batch_ecs.CreateEntities(entity_count, Animals{}, AnimalFood{}, AnimalHabitat{}, AnimalHairStyle{});
+      if (entities.Bad()) {
+        printf("Failed to create batch entities");
+        std::terminate();
+      }
+      batch_timer.CaptureTimePoint(false);
+      batch_timer.PrintAverageTime();
+
+      // The same number of entities spawned from a prefab in ten waves, as a game would spawn them over frames.
+      ECSController prefab_ecs;
+      SetUpConstructionECS(prefab_ecs, system_count);
+      Prefab<Animals, AnimalFood, AnimalHabitat, AnimalHairStyle> animal_prefab(
+        Animals{}, AnimalFood{}, AnimalHabitat{}, AnimalHairStyle{});
+      Timer prefab_timer("Our ECS Instantiate 10 waves (" + std::to_string(system_count) + " systems)");
+      prefab_timer.Start();
+      for (int wave = 0; wave < 10; ++wave) {
+        if (prefab_ecs.Instantiate(animal_prefab, entity_count / 10).Bad()) {
+          printf("Failed to instantiate prefab entities");
+          std::terminate();
+        }
+      }
+      prefab_timer.CaptureTimePoint(false);
+      prefab_timer.PrintAverageTime();
+    }
+    // !!!!!!!!!!!!!!!!!!!!!!!!!!! TEST 10 END !!!!!!!!!!!!!!!!!!!!!!!!!!!
+
     printf("\n--------------\n");
     printf("Tests Complete");
     printf("\n--------------\n");
@@ -0,0 +1,425 @@
+#ifndef INCLUDE_ECS_ARCHETYPE_STORAGE_HPP_
+#define INCLUDE_ECS_ARCHETYPE_STORAGE_HPP_
+
+#include <algorithm>
+#include <array>
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "ankerl/unordered_dense.h"
+
+#include "ecs/ecs_constants.hpp"
+#include "ecs/job_system.hpp"
+#include "ecs/tag_component.hpp"
+#include "ecs/type_index.hpp"
+#include "ids.hpp"
+
+// The set of component types an archetype holds.
+using ComponentMask = std::bitset<MAX_COMPONENT_COUNT>;
+
+// A type erased column of an archetype table. Columns are split into chunks of a fixed number of rows so that growing
+// a table never moves existing rows.
+class IArchetypeColumn
+{
+public:
+  virtual ~IArchetypeColumn() = default;
+  // Create an empty column of the same component type.
+  [[nodiscard]] virtual std::unique_ptr<IArchetypeColumn> CreateEmpty(size_t rows_per_chunk) const = 0;
+  // Move the element at row in source, a column of the same component type, onto the back of this column.
+  virtual void PushFrom(IArchetypeColumn& source, size_t row) = 0;
+  // Remove the element at row by moving the back element into its place.
+  virtual void SwapRemove(size_t row) = 0;
+  [[nodiscard]] virtual size_t ElementSize() const = 0;
+};
+
+template<typename T> class ArchetypeColumn : public IArchetypeColumn
+{
+public:
+  explicit ArchetypeColumn(size_t rows_per_chunk) : rows_per_chunk_(rows_per_chunk) {}
+
+  [[nodiscard]] std::unique_ptr<IArchetypeColumn> CreateEmpty(size_t rows_per_chunk) const override
+  {
+    return std::make_unique<ArchetypeColumn<T>>(rows_per_chunk);
+  }
+
+  void PushFrom(IArchetypeColumn& source, size_t row) override
+  {
+    Emplace(std::move(static_cast<ArchetypeColumn<T>&>(source).Get(row)));
+  }
+
+  void SwapRemove(size_t row) override
+  {
+    auto& back_chunk = chunks_.back();
+    auto& element = Get(row);
+    if (&element != &back_chunk.back()) {
+      element = std::move(back_chunk.back());
+    }
+    back_chunk.pop_back();
+    if (back_chunk.empty()) {
+      chunks_.pop_back();
+    }
+  }
+
+  [[nodiscard]] size_t ElementSize() const override { return sizeof(T); }
+
+  // Construct a component in place at the end of the column.
+  template<typename... Args> void Emplace(Args&&... args)
+  {
+    if (chunks_.empty() || chunks_.back().size() == rows_per_chunk_) {
+      chunks_.emplace_back().reserve(rows_per_chunk_);
+    }
+    chunks_.back().emplace_back(std::forward<Args>(args)...);
+  }
+
+  T& Get(size_t row) { return chunks_[row / rows_per_chunk_][row % rows_per_chunk_]; }
+
+  // Pointer to the first element of a chunk. Rows within a chunk are contiguous.
+  T* ChunkData(size_t chunk) { return chunks_[chunk].data(); }
+
+private:
+  size_t rows_per_chunk_;
+  std::vector<std::vector<T>> chunks_;
+};
+
+// Tags have no value so their column stores nothing. The archetype's mask already says which entities have the tag.
+template<typename T>
+  requires is_tag_component_v<T>
+class ArchetypeColumn<T> : public IArchetypeColumn
+{
+public:
+  explicit ArchetypeColumn(size_t /*rows_per_chunk*/) {}
+
+  [[nodiscard]] std::unique_ptr<IArchetypeColumn> CreateEmpty(size_t rows_per_chunk) const override
+  {
+    return std::make_unique<ArchetypeColumn<T>>(rows_per_chunk);
+  }
+
+  void PushFrom(IArchetypeColumn& /*source*/, size_t /*row*/) override {}
+  void SwapRemove(size_t /*row*/) override {}
+  [[nodiscard]] size_t ElementSize() const override { return 0; }
+
+  template<typename... Args> void Emplace(Args&&... /*args*/) {}
+
+  T& Get(size_t /*row*/) { return TagInstance<T>(); }
+
+  // Use with ComponentAt(), every row of a tag column is TagInstance().
+  T* ChunkData(size_t /*chunk*/) { return &TagInstance<T>(); }
+};
+
+// A table of entities that all have exactly the same set of components. There is one column per component type and
+// row i of every column belongs to the entity at Entities()[i].
+class Archetype
+{
+public:
+  Archetype(const ComponentMask& mask,
+    std::vector<uint32_t> component_ids,
+    std::vector<std::unique_ptr<IArchetypeColumn>> columns,
+    size_t rows_per_chunk)
+    : mask_(mask), component_ids_(std::move(component_ids)), columns_(std::move(columns)),
+      rows_per_chunk_(rows_per_chunk)
+  {}
+
+  [[nodiscard]] const ComponentMask& Mask() const { return mask_; }
+  [[nodiscard]] size_t Size() const { return entities_.size(); }
+  [[nodiscard]] size_t RowsPerChunk() const { return rows_per_chunk_; }
+  [[nodiscard]] size_t ChunkCount() const { return (entities_.size() + rows_per_chunk_ - 1) / rows_per_chunk_; }
+  [[nodiscard]] std::span<const EntityID> Entities() const { return entities_; }
+
+  // Get the column for a component id or nullptr if this archetype doesn't hold that component.
+  [[nodiscard]] IArchetypeColumn* GetColumn(uint32_t component_id) const
+  {
+    auto iter = std::lower_bound(component_ids_.begin(), component_ids_.end(), component_id);
+    if (iter == component_ids_.end() || *iter != component_id) {
+      return nullptr;
+    }
+    return columns_[static_cast<size_t>(iter - component_ids_.begin())].get();
+  }
+
+  template<typename T> [[nodiscard]] ArchetypeColumn<T>* GetColumn() const
+  {
+    return static_cast<ArchetypeColumn<T>*>(GetColumn(type_index<T>::value()));
+  }
+
+private:
+  friend class ArchetypeStorage;
+  ComponentMask mask_;
+  // Component ids sorted in ascending order. columns_ is in the same order.
+  std::vector<uint32_t> component_ids_;
+  std::vector<std::unique_ptr<IArchetypeColumn>> columns_;
+  std::vector<EntityID> entities_;
+  size_t rows_per_chunk_;
+  // Cached transitions to the archetype with a component added or removed.
+  ankerl::unordered_dense::map<uint32_t, Archetype*> add_edges_;
+  ankerl::unordered_dense::map<uint32_t, Archetype*> remove_edges_;
+};
+
+// Stores components in archetype tables. Entities with the same set of components live together, so iterating several
+// components at once is a linear walk over each matching table. Adding or removing a component moves the entity's row
+// to another table.
+class ArchetypeStorage
+{
+public:
+  ArchetypeStorage() = default;
+  ArchetypeStorage(const ArchetypeStorage&) = delete;
+  ArchetypeStorage& operator=(const ArchetypeStorage&) = delete;
+
+  template<typename ComponentName> void RegisterComponent()
+  {
+    const auto id = type_index<ComponentName>::value();
+    if (prototypes_.size() <= id) {
+      prototypes_.resize(id + 1);
+    }
+    prototypes_[id] = std::make_unique<ArchetypeColumn<ComponentName>>(1);
+  }
+
+  [[nodiscard]] bool IsRegistered(uint32_t component_id) const
+  {
+    return component_id < prototypes_.size() && prototypes_[component_id];
+  }
+
+  template<typename ComponentName> void AddComponent(EntityID entity_id, const ComponentName& component)
+  {
+    EmplaceComponent<ComponentName>(entity_id, component);
+  }
+
+  // Construct a component in place from args. If the entity already has the component it's replaced by one built from
+  // args.
+  template<typename ComponentName, typename... Args> void EmplaceComponent(EntityID entity_id, Args&&... args)
+  {
+    const auto id = type_index<ComponentName>::value();
+    auto& record = GetRecord(entity_id);
+    if (record.archetype != nullptr && record.archetype->mask_.test(id)) {
+      record.archetype->GetColumn<ComponentName>()->Get(record.row) = ComponentName(std::forward<Args>(args)...);
+      return;
+    }
+    Archetype* destination = AddTransition(record.archetype, id);
+    MoveEntity(entity_id, destination);
+    destination->GetColumn<ComponentName>()->Emplace(std::forward<Args>(args)...);
+  }
+
+  /**
+   * @brief Add ComponentNames to many entities at once. The destination archetype is looked up once and entities that
+   * don't have any components yet are appended to it directly, skipping the archetype moves of adding one component at
+   * a time. ComponentNames must be distinct.
+   *
+   * @param entity_ids The entities to add the components to.
+   * @param components The values copied into every entity.
+   */
+  template<typename... ComponentNames>
+  void AddComponents(std::span<const EntityID> entity_ids, const ComponentNames&... components)
+  {
+    ComponentMask mask;
+    (mask.set(type_index<ComponentNames>::value()), ...);
+    // Only looked up once an entity without components is found.
+    Archetype* destination = nullptr;
+    for (const auto entity_id : entity_ids) {
+      auto& record = GetRecord(entity_id);
+      if (record.archetype != nullptr) {
+        AddComponents(entity_id, mask, components...);
+        continue;
+      }
+      if (destination == nullptr) {
+        destination = GetOrCreateArchetype(mask);
+        destination->entities_.reserve(destination->entities_.size() + entity_ids.size());
+      }
+      record.archetype = destination;
+      record.row = static_cast<uint32_t>(destination->Size());
+      destination->entities_.push_back(entity_id);
+      (destination->GetColumn<ComponentNames>()->Emplace(components), ...);
+    }
+  }
+
+  // Remove ComponentNames from an entity with a single move to the archetype without them.
+  template<typename... ComponentNames> void RemoveComponents(EntityID entity_id)
+  {
+    auto& record = GetRecord(entity_id);
+    if (record.archetype == nullptr) {
+      return;
+    }
+    ComponentMask mask;
+    (mask.set(type_index<ComponentNames>::value()), ...);
+    if ((record.archetype->mask_ & mask).none()) {
+      return;
+    }
+    MoveEntity(entity_id, GetOrCreateArchetype(record.archetype->mask_ & ~mask));
+  }
+
+  template<typename ComponentName> void RemoveComponent(EntityID entity_id)
+  {
+    const auto id = type_index<ComponentName>::value();
+    auto& record = GetRecord(entity_id);
+    if (record.archetype == nullptr || !record.archetype->mask_.test(id)) {
+      return;
+    }
+    MoveEntity(entity_id, RemoveTransition(record.archetype, id));
+  }
+
+  template<typename ComponentName> [[nodiscard]] ComponentName* GetComponent(EntityID entity_id)
+  {
+    static_assert(!is_tag_component_v<ComponentName>, "Tag components have no value, use HasComponent()");
+    if (entity_id.Index() >= records_.size()) {
+      return nullptr;
+    }
+    const auto& record = records_[entity_id.Index()];
+    if (record.archetype == nullptr) {
+      return nullptr;
+    }
+    auto* column = record.archetype->GetColumn<ComponentName>();
+    return column != nullptr ? &column->Get(record.row) : nullptr;
+  }
+
+  template<typename ComponentName> [[nodiscard]] bool HasComponent(EntityID entity_id) const
+  {
+    return entity_id.Index() < records_.size() && records_[entity_id.Index()].archetype != nullptr
+           && records_[entity_id.Index()].archetype->mask_.test(type_index<ComponentName>::value());
+  }
+
+  template<typename ComponentName> [[nodiscard]] size_t ComponentCount() const
+  {
+    size_t count = 0;
+    for (const auto& archetype : archetypes_) {
+      if (archetype->mask_.test(type_index<ComponentName>::value())) {
+        count += archetype->Size();
+      }
+    }
+    return count;
+  }
+
+  // Remove all of an entity's components.
+  void EntityDestroyed(EntityID entity_id);
+
+  /**
+   * @brief Call func(EntityID, ComponentNames&...) for every entity that has all of ComponentNames. Each matching
+   * archetype is walked chunk by chunk so component access is linear.
+   */
+  template<typename... ComponentNames, typename Func> void Each(Func&& func)
+  {
+    ComponentMask required;
+    (required.set(type_index<ComponentNames>::value()), ...);
+    for (const auto& archetype : archetypes_) {
+      if (archetype->Size() == 0 || (archetype->mask_ & required) != required) {
+        continue;
+      }
+      auto columns = std::make_tuple(archetype->GetColumn<ComponentNames>()...);
+      const auto entities = archetype->Entities();
+      const size_t rows_per_chunk = archetype->RowsPerChunk();
+      for (size_t chunk = 0; chunk < archetype->ChunkCount(); ++chunk) {
+        const size_t first_row = chunk * rows_per_chunk;
+        const size_t row_count = std::min(rows_per_chunk, entities.size() - first_row);
+        std::apply(
+          [&](auto*... column) {
+            auto data = std::make_tuple(column->ChunkData(chunk)...);
+            for (size_t row = 0; row < row_count; ++row) {
+              std::apply(
+                [&](auto*... components) { func(entities[first_row + row], ComponentAt(components, row)...); }, data);
+            }
+          },
+          columns);
+      }
+    }
+  }
+
+  /**
+   * @brief Call func(EntityID, ComponentNames&...) for every entity that has all of ComponentNames, spread over the
+   * threads of job_system. Each chunk of each matching archetype is one piece of work, so threads never share a chunk.
+   * If min_grain or fewer entities match, everything runs on the calling thread.
+   */
+  template<typename... ComponentNames, typename Func>
+  void ParallelEach(JobSystem& job_system, Func&& func, size_t min_grain = DEFAULT_PARALLEL_MIN_GRAIN)
+  {
+    ComponentMask required;
+    (required.set(type_index<ComponentNames>::value()), ...);
+    std::vector<std::pair<Archetype*, size_t>> work;
+    size_t entity_count = 0;
+    for (const auto& archetype : archetypes_) {
+      if (archetype->Size() == 0 || (archetype->mask_ & required) != required) {
+        continue;
+      }
+      entity_count += archetype->Size();
+      for (size_t chunk = 0; chunk < archetype->ChunkCount(); ++chunk) {
+        work.emplace_back(archetype.get(), chunk);
+      }
+    }
+    if (entity_count <= min_grain) {
+      Each<ComponentNames...>(func);
+      return;
+    }
+    job_system.ParallelFor(work.size(), [&](size_t index) {
+      auto [archetype, chunk] = work[index];
+      const auto entities = archetype->Entities();
+      const size_t first_row = chunk * archetype->RowsPerChunk();
+      const size_t row_count = std::min(archetype->RowsPerChunk(), entities.size() - first_row);
+      auto data = std::make_tuple(archetype->GetColumn<ComponentNames>()->ChunkData(chunk)...);
+      std::apply(
+        [&](auto*... components) {
+          for (size_t row = 0; row < row_count; ++row) {
+            func(entities[first_row + row], ComponentAt(components, row)...);
+          }
+        },
+        data);
+    });
+  }
+
+  [[nodiscard]] size_t ArchetypeCount() const { return archetypes_.size(); }
+
+private:
+  struct EntityRecord
+  {
+    Archetype* archetype{ nullptr };
+    uint32_t row{ 0 };
+  };
+
+  EntityRecord& GetRecord(EntityID entity_id)
+  {
+    if (entity_id.Index() >= records_.size()) {
+      records_.resize(entity_id.Index() + 1);
+    }
+    return records_[entity_id.Index()];
+  }
+
+  // Add the components in mask to an entity that already has a row, moving it once to the archetype with all of them.
+  // Components the entity already has are overwritten in place.
+  template<typename... ComponentNames>
+  void AddComponents(EntityID entity_id, const ComponentMask& mask, const ComponentNames&... components)
+  {
+    const ComponentMask before = records_[entity_id.Index()].archetype->mask_;
+    if ((before | mask) != before) {
+      MoveEntity(entity_id, GetOrCreateArchetype(before | mask));
+    }
+    const auto& record = records_[entity_id.Index()];
+    (
+      [&] {
+        auto* column = record.archetype->GetColumn<ComponentNames>();
+        if (before.test(type_index<ComponentNames>::value())) {
+          column->Get(record.row) = components;
+        } else {
+          column->Emplace(components);
+        }
+      }(),
+      ...);
+  }
+
+  Archetype* GetOrCreateArchetype(const ComponentMask& mask);
+  Archetype* AddTransition(Archetype* from, uint32_t component_id);
+  Archetype* RemoveTransition(Archetype* from, uint32_t component_id);
+  // Move an entity's row into destination. Columns that both archetypes share are moved across, any others are
+  // dropped. Columns in destination that the source doesn't have are left for the caller to push.
+  void MoveEntity(EntityID entity_id, Archetype* destination);
+  // Swap remove a row from an archetype and fix up the record of the entity that was moved into its place.
+  void RemoveRow(Archetype* archetype, uint32_t row);
+
+  // Indexed by entity
+  std::vector<EntityRecord> records_;
+  // An empty column per registered component, indexed by component id, used to create the columns of new archetypes.
+  std::vector<std::unique_ptr<IArchetypeColumn>> prototypes_;
+  std::vector<std::unique_ptr<Archetype>> archetypes_;
+  ankerl::unordered_dense::map<ComponentMask, Archetype*> archetype_lookup_;
+};
+
+#endif// !INCLUDE_ECS_ARCHETYPE_STORAGE_HPP_
@@ -0,0 +1,186 @@
+#ifndef INCLUDE_ECS_COMMAND_BUFFER_HPP_
+#define INCLUDE_ECS_COMMAND_BUFFER_HPP_
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include "ecs/component_manager.hpp"
+#include "ecs/entity.hpp"
+#include "ecs/entity_manager.hpp"
+#include "ecs/system_manager_interface.hpp"
+#include "error.hpp"
+#include "ids.hpp"
+#include "result.hpp"
+
+// Records structural changes (create, destroy, add component and remove component) so they can be applied later in
+// one batch with Flush(). This makes it safe to change entities while iterating an EntitySet or a View.
+// On Flush() the recorded component changes are applied grouped per component array, in the order they were recorded
+// for each array. Each changed entity then has its signature updated once, however many of its components changed,
+// and finally the destroyed entities are destroyed.
+class CommandBuffer
+{
+public:
+  // A default constructed buffer isn't bound to a world, call SetWorld() before recording into it.
+  CommandBuffer() = default;
+  explicit CommandBuffer(uint32_t world_index) : world_(world_index) {}
+  CommandBuffer(const CommandBuffer&) = delete;
+  CommandBuffer& operator=(const CommandBuffer&) = delete;
+
+  // Set the world the commands are applied to.
+  void SetWorld(uint32_t world_index) { world_ = world_index; }
+
+  /**
+   * @brief Create an entity. The entity id is reserved straight away so components can be recorded against it, but no
+   * system will see the entity until Flush(), even one whose entity sets match every entity.
+   *
+   * @return Result<EntityID> The new entity id or an error if the maximum entity count has been reached.
+   */
+  [[nodiscard]] Result<EntityID> CreateEntity()
+  {
+    auto entity_id = World().entity_manager->CreateEntity();
+    if (entity_id.Good()) {
+      changes_.push_back({ *entity_id, NO_COMPONENT, false });
+      ++command_count_;
+    }
+    return entity_id;
+  }
+
+  // Record adding a component to an entity. The component is moved into the buffer and again into storage on Flush(),
+  // so move-only components work. Returns an error if the component hasn't been registered.
+  template<typename ComponentName>
+  [[nodiscard]] Error AddComponent(EntityID entity_id, ComponentName component = ComponentName{})
+  {
+    auto queue = GetQueue<ComponentName>();
+    if (queue.Bad()) {
+      return queue.Error();
+    }
+    (*queue)->commands.emplace_back(entity_id, std::move(component));
+    ++command_count_;
+    return Error::OK();
+  }
+
+  // Record removing a component from an entity. Returns an error if the component hasn't been registered.
+  template<typename ComponentName> [[nodiscard]] Error RemoveComponent(EntityID entity_id)
+  {
+    auto queue = GetQueue<ComponentName>();
+    if (queue.Bad()) {
+      return queue.Error();
+    }
+    (*queue)->commands.emplace_back(entity_id, std::nullopt);
+    ++command_count_;
+    return Error::OK();
+  }
+
+  // Record destroying an entity. Destroys are applied after every component change so any component changes recorded
+  // for a destroyed entity are dropped.
+  void DestroyEntity(EntityID entity_id)
+  {
+    destroyed_.push_back(entity_id);
+    ++command_count_;
+  }
+
+  // Apply every recorded command and clear the buffer. A command that can't be applied, for example one for an entity
+  // that was destroyed before the flush, is skipped and the rest are still applied. Returns the first such error.
+  Error Flush();
+
+  [[nodiscard]] bool Empty() const { return command_count_ == 0; }
+
+private:
+  // A component that was added to or removed from an entity during a Flush(). An entity created through the buffer has
+  // a change with NO_COMPONENT so its signature is applied even if it never gets a component.
+  struct SignatureChange
+  {
+    EntityID entity_id;
+    size_t component_id;
+    bool added;
+  };
+  static constexpr size_t NO_COMPONENT = std::numeric_limits<size_t>::max();
+
+  class ICommandQueue
+  {
+  public:
+    // Apply the queued commands to the component manager, skipping entities in destroyed (which must be sorted), and
+    // append the signature change of each applied command to changes. Commands for entities that aren't alive are
+    // skipped, returns the first command that couldn't be applied.
+    virtual Error Apply(ComponentManager& component_manager,
+      const EntityManager& entity_manager,
+      std::span<const EntityID> destroyed,
+      std::vector<SignatureChange>& changes) = 0;
+    virtual ~ICommandQueue() = default;
+  };
+
+  // The add and remove commands of one component type in the order they were recorded. A command without a value is a
+  // remove.
+  template<typename T> class CommandQueue : public ICommandQueue
+  {
+  public:
+    explicit CommandQueue(size_t component_id) : component_id_(component_id) {}
+
+    Error Apply(ComponentManager& component_manager,
+      const EntityManager& entity_manager,
+      std::span<const EntityID> destroyed,
+      std::vector<SignatureChange>& changes) override
+    {
+      Error first_error = Error::OK();
+      for (auto& [entity_id, component] : commands) {
+        if (std::binary_search(destroyed.begin(), destroyed.end(), entity_id)) {
+          continue;
+        }
+        Error err = Error::OK();
+        if (!entity_manager.IsAlive(entity_id)) {
+          err = Error{ "Entity isn't alive" };
+        } else if (component.has_value()) {
+          err = component_manager.EmplaceComponent<T>(entity_id, std::move(*component));
+        } else {
+          err = component_manager.RemoveComponent<T>(entity_id);
+        }
+        if (err.Good()) {
+          changes.push_back({ entity_id, component_id_, component.has_value() });
+        } else if (first_error.Good()) {
+          first_error = err;
+        }
+      }
+      commands.clear();
+      return first_error;
+    }
+
+    std::vector<std::pair<EntityID, std::optional<T>>> commands;
+
+  private:
+    size_t component_id_;
+  };
+
+  [[nodiscard]] const EntityWorld& World() const { return EntityWorlds::Get(world_); }
+
+  template<typename ComponentName> Result<CommandQueue<ComponentName>*> GetQueue()
+  {
+    auto comp_id = World().component_manager->GetComponentID<ComponentName>();
+    if (comp_id.Bad()) {
+      return comp_id.Error();
+    }
+    const auto id = static_cast<size_t>((*comp_id).Get());
+    if (queues_.size() <= id) {
+      queues_.resize(id + 1);
+    }
+    if (!queues_[id]) {
+      queues_[id] = std::make_unique<CommandQueue<ComponentName>>(id);
+    }
+    return static_cast<CommandQueue<ComponentName>*>(queues_[id].get());
+  }
+
+  // Indexed by component id so Flush() applies the changes a component array at a time.
+  std::vector<std::unique_ptr<ICommandQueue>> queues_;
+  std::vector<EntityID> destroyed_;
+  // Reused between flushes to avoid reallocating.
+  std::vector<SignatureChange> changes_;
+  size_t command_count_{ 0 };
+  uint32_t world_{ EntityWorlds::INVALID_WORLD };
+};
+
+#endif// !INCLUDE_ECS_COMMAND_BUFFER_HPP_
@@ -1,99 +1,280 @@
 #ifndef INCLUDE_ECS_COMPONENT_ARRAY_H_
 #define INCLUDE_ECS_COMPONENT_ARRAY_H_
 
-#include <stack>
-#include <unordered_map>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
 #include "ankerl/unordered_dense.h"
 
 #include "ecs/ecs_constants.hpp"
+#include "ecs/sparse_index.hpp"
+#include "ecs/tag_component.hpp"
 #include "ids.hpp"
 
-template<typename T> class ComponentWrapper
+class IComponentArray
 {
 public:
-  ComponentWrapper(T component, EntityID id) : component(component), id(id) {}
-  T component;
-  EntityID id;
+  virtual void RemoveComponent(EntityID) = 0;
+  virtual ~IComponentArray() = default;
 };
 
-class IComponentArray
+// A group that owns a set of component arrays. Owned arrays inform their group when a component is added or is about to
+// be removed so the group can keep its entities packed at the front of every array.
+class IGroup
 {
 public:
-  virtual void RemoveComponent(EntityID) = 0;
-  virtual ~IComponentArray() = default;
+  virtual void ComponentAdded(EntityID entity_id) = 0;
+  virtual void ComponentRemoved(EntityID entity_id) = 0;
+  virtual ~IGroup() = default;
 };
 
+// True if tick is after since. Ticks are compared by their difference so they keep working once the counter wraps, as
+// long as since isn't more than 2^31 ticks old.
+[[nodiscard]] inline bool IsNewerTick(uint32_t tick, uint32_t since)
+{
+  return static_cast<int32_t>(tick - since) > 0;
+}
+
+// Every component also records the tick it was added on and the tick it was last changed on, in arrays parallel to the
+// components. The ticks are read from the tick source, normally the owning ComponentManager's tick, and are 0 without
+// one. Adding, replacing and mutable access through a View, Group or the ComponentManager mark a component changed.
+// Tag components, empty types, only keep the entities and ticks. There are no values so GetComponent() and
+// GetComponents() aren't available for them.
 template<typename T> class ComponentArray : public IComponentArray
 {
 public:
-  explicit ComponentArray(ComponentID<T> id) : id_(id)
-  {
-    // First slot in components_ is reserved
-    components_.emplace_back(T{}, EntityID(0));
-  }
+  explicit ComponentArray(ComponentID<T> id) : id_(id) {}
   ComponentArray(ComponentArray&&) = default;
   ComponentArray(const ComponentArray&) = default;
   ComponentArray& operator=(ComponentArray&&) = default;
   ComponentArray& operator=(const ComponentArray&) = default;
 
-  void AddComponent(EntityID entity_id, const T& component)
+  void AddComponent(EntityID entity_id, const T& component) { EmplaceComponent(entity_id, component); }
+
+  // Construct a component in place from args. If the entity already has the component it's replaced by one built from
+  // args. Works with move-only components.
+  template<typename... Args> void EmplaceComponent(EntityID entity_id, Args&&... args)
   {
-    // Check if there are any free slots in the components_ vector we can use
-    // first.
-    if (!free_slots_.empty()) {
-      // There is a free slot, let's use it instead of allocating more space
-      // into the components_ vector.
-      const auto& index = free_slots_.top();
-      components_[index].component = component;
-      components_[index].id = entity_id;
-      // Update the entity position map before we overwrite the component
-      entity_index_map_[entity_id.Get()] = index;
-      // Pop now we're not using the references from the front of the queue
-      free_slots_.pop();
-    } else {
-      components_.emplace_back(component, entity_id);
-      entity_index_map_[entity_id.Get()] = components_.size() - 1;
+    const auto index = entity_index_map_.Get(entity_id.Index());
+    if (index != SparseIndex::INVALID_INDEX) {
+      if constexpr (!IS_TAG) {
+        components_[index] = T(std::forward<Args>(args)...);
+      }
+      changed_ticks_[index] = CurrentTick();
+      return;
+    }
+    entity_index_map_.Set(entity_id.Index(), static_cast<uint32_t>(entities_.size()));
+    if constexpr (!IS_TAG) {
+      components_.emplace_back(std::forward<Args>(args)...);
+    }
+    entities_.push_back(entity_id);
+    added_ticks_.push_back(CurrentTick());
+    changed_ticks_.push_back(CurrentTick());
+    if (group_ != nullptr) {
+      group_->ComponentAdded(entity_id);
+    }
+  }
+
+  // Add a copy of component to every entity in entity_ids, growing the packed arrays at most once. If none of the
+  // entities have the component yet, as with newly created entities, the copies are appended as one block.
+  void AddComponents(std::span<const EntityID> entity_ids, const T& value)
+  {
+    // Copy first, value may be a component of this array and growing the array would leave it dangling.
+    const T component = value;
+    const size_t first = entities_.size();
+    const size_t required = first + entity_ids.size();
+    if (entities_.capacity() < required) {
+      // Keep the geometric growth of push_back so repeated batches don't reallocate every time.
+      const size_t capacity = std::max(required, entities_.capacity() * 2);
+      if constexpr (!IS_TAG) {
+        components_.reserve(capacity);
+      }
+      entities_.reserve(capacity);
+      added_ticks_.reserve(capacity);
+      changed_ticks_.reserve(capacity);
+    }
+    const bool any_existing = std::any_of(
+      entity_ids.begin(), entity_ids.end(), [this](EntityID entity_id) { return HasComponent(entity_id); });
+    if (any_existing) {
+      for (const auto entity_id : entity_ids) {
+        AddComponent(entity_id, component);
+      }
+      return;
+    }
+    if constexpr (!IS_TAG) {
+      components_.insert(components_.end(), entity_ids.size(), component);
+    }
+    entities_.insert(entities_.end(), entity_ids.begin(), entity_ids.end());
+    added_ticks_.insert(added_ticks_.end(), entity_ids.size(), CurrentTick());
+    changed_ticks_.insert(changed_ticks_.end(), entity_ids.size(), CurrentTick());
+    for (size_t offset = 0; offset < entity_ids.size(); ++offset) {
+      entity_index_map_.Set(entity_ids[offset].Index(), static_cast<uint32_t>(first + offset));
+    }
+    if (group_ != nullptr) {
+      for (const auto entity_id : entity_ids) {
+        group_->ComponentAdded(entity_id);
+      }
     }
   }
 
   void RemoveComponent(EntityID entity_id) override
   {
     // Check if entity was even added to this component
-    if (entity_index_map_[entity_id.Get()] != 0 && components_.size() - free_slots_.size() != 0) {
-      auto& back_component = components_[components_.size() - 1 - free_slots_.size()];
-      // Replace removed component with the back of the vector
-      components_[entity_index_map_[entity_id.Get()]] = back_component;
-      // Push a free slot onto the queue
-      auto back_component_index = entity_index_map_[back_component.id.Get()];
-      free_slots_.push(back_component_index);
-      // Update the index map with the new position
-      entity_index_map_[back_component.id.Get()] = entity_index_map_[entity_id.Get()];
+    auto index = entity_index_map_.Get(entity_id.Index());
+    if (index == SparseIndex::INVALID_INDEX) {
+      return;
+    }
+    if (group_ != nullptr) {
+      // The group may move the entity out of its packed range so look the index up again.
+      group_->ComponentRemoved(entity_id);
+      index = entity_index_map_.GetUnchecked(entity_id.Index());
     }
+    // Move the back of the arrays into the removed component's place and update the index map with its new position.
+    // This keeps components_ and entities_ packed, and pop_back() destroys the moved from back element.
+    const auto back_entity = entities_.back();
+    entity_index_map_.Set(back_entity.Index(), index);
+    if constexpr (!IS_TAG) {
+      if (index != components_.size() - 1) {
+        components_[index] = std::move(components_.back());
+      }
+      components_.pop_back();
+    }
+    entities_[index] = back_entity;
+    added_ticks_[index] = added_ticks_.back();
+    changed_ticks_[index] = changed_ticks_.back();
+    entities_.pop_back();
+    added_ticks_.pop_back();
+    changed_ticks_.pop_back();
+    entity_index_map_.Reset(entity_id.Index());
   }
 
+  [[nodiscard]] bool HasComponent(EntityID entity_id) const { return entity_index_map_.Contains(entity_id.Index()); }
 
-  [[nodiscard]] size_t Size() const { return components_.size() - 1 - free_slots_.size(); }
+  [[nodiscard]] size_t Size() const { return entities_.size(); }
 
-  T& GetComponent(EntityID entity_id) { return components_[entity_index_map_[entity_id.Get()]].component; }
+  T& GetComponent(EntityID entity_id)
+  {
+    static_assert(!IS_TAG, "Tag components have no value, use HasComponent()");
+    return components_[entity_index_map_.GetUnchecked(entity_id.Index())];
+  }
 
-  ~ComponentArray<T>() override = default;
+  // Get the component of an entity or nullptr if the entity doesn't have one.
+  T* TryGetComponent(EntityID entity_id)
+  {
+    static_assert(!IS_TAG, "Tag components have no value, use HasComponent()");
+    const auto index = entity_index_map_.Get(entity_id.Index());
+    return index != SparseIndex::INVALID_INDEX ? &components_[index] : nullptr;
+  }
+
+  // The live components, packed contiguously. Element i belongs to the entity at GetEntities()[i].
+  [[nodiscard]] std::span<T> GetComponents()
+  {
+    static_assert(!IS_TAG, "Tag components have no value, use GetEntities()");
+    return components_;
+  }
+
+  // The first component for iterating with ComponentAt(). For tags this is TagInstance() whatever the size.
+  [[nodiscard]] T* Data()
+  {
+    if constexpr (IS_TAG) {
+      return &TagInstance<T>();
+    } else {
+      return components_.data();
+    }
+  }
+
+  // The entities that own each component in GetComponents(), in the same order.
+  [[nodiscard]] std::span<const EntityID> GetEntities() const { return entities_; }
+
+  // Get the position of an entity's component in GetComponents() or SparseIndex::INVALID_INDEX.
+  [[nodiscard]] uint32_t IndexOf(EntityID entity_id) const { return entity_index_map_.Get(entity_id.Index()); }
+
+  // Swap the packed positions of two components.
+  void Swap(uint32_t lhs, uint32_t rhs)
+  {
+    if (lhs == rhs) {
+      return;
+    }
+    if constexpr (!IS_TAG) {
+      std::swap(components_[lhs], components_[rhs]);
+    }
+    std::swap(entities_[lhs], entities_[rhs]);
+    std::swap(added_ticks_[lhs], added_ticks_[rhs]);
+    std::swap(changed_ticks_[lhs], changed_ticks_[rhs]);
+    entity_index_map_.Set(entities_[lhs].Index(), lhs);
+    entity_index_map_.Set(entities_[rhs].Index(), rhs);
+  }
+
+  // The tick each component in GetComponents() was added on, in the same order.
+  [[nodiscard]] std::span<const uint32_t> GetAddedTicks() const { return added_ticks_; }
+
+  // The tick each component in GetComponents() was last changed on, in the same order. Adding a component also counts
+  // as changing it.
+  [[nodiscard]] std::span<const uint32_t> GetChangedTicks() const { return changed_ticks_; }
+
+  // Mark an entity's component as changed on the current tick. Needed after writing through GetComponents().
+  void MarkChanged(EntityID entity_id)
+  {
+    const auto index = entity_index_map_.Get(entity_id.Index());
+    if (index != SparseIndex::INVALID_INDEX) {
+      changed_ticks_[index] = CurrentTick();
+    }
+  }
+
+  // Mark the component at component, which must point into GetComponents(), as changed on the current tick.
+  void MarkChanged(const T* component)
+  {
+    static_assert(!IS_TAG, "Tag components have no value, use MarkChanged(EntityID)");
+    changed_ticks_[static_cast<size_t>(component - components_.data())] = CurrentTick();
+  }
+
+  // Mark the components in [begin, end) of GetComponents() as changed on the current tick.
+  void MarkChanged(size_t begin, size_t end)
+  {
+    std::fill(changed_ticks_.begin() + static_cast<std::ptrdiff_t>(begin),
+      changed_ticks_.begin() + static_cast<std::ptrdiff_t>(end),
+      CurrentTick());
+  }
+
+  // The tick new and changed components are stamped with. tick must outlive the array.
+  void SetTickSource(const uint32_t* tick) { tick_ = tick; }
+  [[nodiscard]] uint32_t CurrentTick() const { return tick_ != nullptr ? *tick_ : 0; }
+
+  // The group that owns this array, if any.
+  [[nodiscard]] IGroup* GetGroup() const { return group_; }
+  void SetGroup(IGroup* group) { group_ = group; }
+
+  ~ComponentArray() override = default;
 
   ComponentID<T> GetID() {
     return id_;
   }
 
 private:
-  std::array<size_t, MAX_ENTITY_COUNT + 1> entity_index_map_{};
-  std::vector<ComponentWrapper<T>> components_;
+  static constexpr bool IS_TAG = is_tag_component_v<T>;
 
-  // Track free slots in the components_ vector.
-  std::stack<size_t> free_slots_;
+  // Maps an entity to its position in components_. Pages are only allocated for entity ranges that use this component.
+  SparseIndex entity_index_map_;
+  // Components and their owning entities are stored as two parallel packed arrays so iterating components only
+  // touches component data. Always empty for tags.
+  std::vector<T> components_;
+  std::vector<EntityID> entities_;
+  // The added and last changed tick of each component, parallel to components_. Kept apart from the components so
+  // filtering on a tick only reads the ticks.
+  std::vector<uint32_t> added_ticks_;
+  std::vector<uint32_t> changed_ticks_;
+  const uint32_t* tick_{ nullptr };
 
   // ComponentID that this array represents
   ComponentID<T> id_;
+
+  // Set if a Group owns this array.
+  IGroup* group_{ nullptr };
 };
 
 #endif
\ No newline at end of file
@@ -3,53 +3,60 @@
 
 #include <cstddef>
 #include <memory>
+#include <span>
+#include <tuple>
+#include <type_traits>
 #include <vector>
 
 #include "ankerl/unordered_dense.h"
+#include "ecs/archetype_storage.hpp"
 #include "ecs/component_array.hpp"
 #include "ecs/ecs_constants.hpp"
+#include "ecs/group.hpp"
+#include "ecs/resources.hpp"
+#include "ecs/shared_component_array.hpp"
+#include "ecs/system_signature.hpp"
+#include "ecs/type_index.hpp"
+#include "ecs/view.hpp"
 #include "error.hpp"
 #include "ids.hpp"
 #include "result.hpp"
 
-namespace internal {
-struct type_index final
-{
-  [[nodiscard]] static uint32_t next() noexcept
-  {
-    static uint32_t value{};
-    return value++;
-  }
-};
-}// namespace internal
-
-template<typename Type, typename = void> struct type_index final
-{
-  static uint32_t value() noexcept
-  {
-    static const uint32_t value = internal::type_index::next();
-    return value;
-  }
-  constexpr operator uint32_t() const noexcept { return value(); }
-};
-
 class ComponentManager
 {
 public:
-  ComponentManager() = default;
+  explicit ComponentManager(StorageMode storage_mode = StorageMode::Sparse) : storage_mode_(storage_mode) {}
   ComponentManager(const ComponentManager&) = delete;
   ComponentManager& operator=(const ComponentManager&) = delete;
 
   // Chose to use ComponentID so that we don't have to do any fancy
   // type resolution with typeid to get the correct IComponentArray.
+  // Components with is_shared_component_v set get a SharedComponentArray, which isn't available with archetype storage.
   template<typename ComponentName> Error RegisterComponent()
   {
     Error err = Error::OK();
-    int id = type_index<ComponentName>::value();
+    auto id = type_index<ComponentName>::value();
     if (id < MAX_COMPONENT_COUNT) {
-      ComponentID<ComponentName> comp_id(id);
-      components_.emplace_back(std::make_unique<ComponentArray<ComponentName>>(comp_id));
-      component_index_count_ = id;
+      if constexpr (is_shared_component_v<ComponentName>) {
+        if (storage_mode_ == StorageMode::Archetype) {
+          return Error{ "Shared components aren't supported with archetype storage" };
+        }
+        if (components_.size() <= id) {
+          components_.resize(id + 1);
+        }
+        components_[id] = std::make_unique<SharedComponentArray<ComponentName>>(ComponentID<ComponentName>(id));
+      } else if (storage_mode_ == StorageMode::Archetype) {
+        archetypes_.RegisterComponent<ComponentName>();
+      } else {
+        // Component arrays are indexed by their type index. Type indices are shared between ComponentManagers so
+        // there can be gaps.
+        if (components_.size() <= id) {
+          components_.resize(id + 1);
+        }
+        auto array = std::make_unique<ComponentArray<ComponentName>>(ComponentID<ComponentName>(id));
+        array->SetTickSource(&tick_);
+        components_[id] = std::move(array);
+      }
     } else {
       err = Error{ "Maximum components registered exceeded" };
     }
@@ -58,17 +65,64 @@ public:
 
   template<typename ComponentName> Error AddComponent(EntityID entity_id, const ComponentName& comp)
   {
+    return EmplaceComponent<ComponentName>(entity_id, comp);
+  }
+
+  // Construct a component in place from args, replacing the entity's existing one if it has one. Works with move-only
+  // components.
+  template<typename ComponentName, typename... Args> Error EmplaceComponent(EntityID entity_id, Args&&... args)
+  {
+    if (storage_mode_ == StorageMode::Archetype) {
+      if (!archetypes_.IsRegistered(type_index<ComponentName>::value())) {
+        return Error{ "Component hasn't been registered" };
+      }
+      archetypes_.EmplaceComponent<ComponentName>(entity_id, std::forward<Args>(args)...);
+      return Error::OK();
+    }
     auto comp_array = GetComponentArray<ComponentName>();
     if (comp_array.Good()) {
-      comp_array->AddComponent(entity_id, comp);
+      comp_array->EmplaceComponent(entity_id, std::forward<Args>(args)...);
       return Error::OK();
     } else {
       return comp_array.Error();
     }
   }
 
+  // Add a copy of each of components to every entity in entity_ids. Each component array, or the destination archetype,
+  // is looked up and grown once for the whole batch. Nothing is added if any component hasn't been registered.
+  template<typename... ComponentNames>
+  Error AddComponents(std::span<const EntityID> entity_ids, const ComponentNames&... components)
+  {
+    if (storage_mode_ == StorageMode::Archetype) {
+      if (!(archetypes_.IsRegistered(type_index<ComponentNames>::value()) && ...)) {
+        return Error{ "Component hasn't been registered" };
+      }
+      // Copy first, a component may live in a column that moving the entities reallocates.
+      std::apply([&](const auto&... values) { archetypes_.AddComponents(entity_ids, values...); },
+        std::tuple<ComponentNames...>(components...));
+      return Error::OK();
+    }
+    auto arrays = std::make_tuple(GetComponentArray<ComponentNames>()...);
+    return std::apply(
+      [&](auto&... comp_arrays) -> Error {
+        if (!(comp_arrays.Good() && ...)) {
+          return Error{ "Component hasn't been registered" };
+        }
+        ((*comp_arrays)->AddComponents(entity_ids, components), ...);
+        return Error::OK();
+      },
+      arrays);
+  }
+
   template<typename ComponentName> Error RemoveComponent(EntityID entity_id)
   {
+    if (storage_mode_ == StorageMode::Archetype) {
+      if (!archetypes_.IsRegistered(type_index<ComponentName>::value())) {
+        return Error{ "Component hasn't been registered" };
+      }
+      archetypes_.RemoveComponent<ComponentName>(entity_id);
+      return Error::OK();
+    }
     auto comp_array = GetComponentArray<ComponentName>();
     if (comp_array.Good()) {
       comp_array->RemoveComponent(entity_id);
@@ -78,20 +132,109 @@ public:
     }
   }
 
+  // Remove every one of ComponentNames the entity has. Nothing is removed if any component hasn't been registered.
+  template<typename... ComponentNames> Error RemoveComponents(EntityID entity_id)
+  {
+    if (storage_mode_ == StorageMode::Archetype) {
+      if (!(archetypes_.IsRegistered(type_index<ComponentNames>::value()) && ...)) {
+        return Error{ "Component hasn't been registered" };
+      }
+      archetypes_.RemoveComponents<ComponentNames...>(entity_id);
+      return Error::OK();
+    }
+    auto arrays = std::make_tuple(GetComponentArray<ComponentNames>()...);
+    return std::apply(
+      [entity_id](auto&... comp_arrays) -> Error {
+        if (!(comp_arrays.Good() && ...)) {
+          return Error{ "Component hasn't been registered" };
+        }
+        ((*comp_arrays)->RemoveComponent(entity_id), ...);
+        return Error::OK();
+      },
+      arrays);
+  }
+
+  // Remove the entity from every component array.
   void EntityDestroyed(EntityID entity_id);
+  // Remove the entity from only the component arrays in signature, the components the entity owns.
+  void EntityDestroyed(EntityID entity_id, const SystemSignature& signature);
 
+  // Reading a component doesn't mark it changed, so it's safe from systems that only declare read access. Write through
+  // GetComponentMut() so the change is seen by Changed<T>. Not available for tag components, use HasComponent().
   template<typename ComponentName> Result<ComponentName*> GetComponent(EntityID entity_id)
   {
+    static_assert(!is_tag_component_v<ComponentName>, "Tag components have no value, use HasComponent()");
+    static_assert(!is_shared_component_v<ComponentName>, "Shared components are read only, use GetSharedComponent()");
+    if (storage_mode_ == StorageMode::Archetype) {
+      auto* component = archetypes_.GetComponent<ComponentName>(entity_id);
+      if (component == nullptr) {
+        return Error{ "Entity doesn't have this component" };
+      }
+      return component;
+    }
     auto comp_array = GetComponentArray<ComponentName>();
     if (comp_array.Good()) {
-      return &comp_array->GetComponent(entity_id);
+      auto* component = comp_array->TryGetComponent(entity_id);
+      if (component == nullptr) {
+        return Error{ "Entity doesn't have this component" };
+      }
+      return component;
     } else {
       return comp_array.Error();
     }
   }
 
+  // Get a component to write to and mark it changed on the current tick. The caller must have write access to the
+  // component. Archetype storage doesn't track ticks so nothing is marked there, and View rejects tick filters.
+  template<typename ComponentName> Result<ComponentName*> GetComponentMut(EntityID entity_id)
+  {
+    auto component = GetComponent<ComponentName>(entity_id);
+    if (component.Good() && storage_mode_ == StorageMode::Sparse) {
+      (*GetComponentArray<ComponentName>())->MarkChanged(*component);
+    }
+    return component;
+  }
+
+  // Get the value of an entity's shared component. The value is shared with every entity that has an equal one.
+  template<typename ComponentName> Result<const ComponentName*> GetSharedComponent(EntityID entity_id)
+  {
+    static_assert(is_shared_component_v<ComponentName>);
+    auto comp_array = GetComponentArray<ComponentName>();
+    if (comp_array.Bad()) {
+      return comp_array.Error();
+    }
+    const auto* component = comp_array->TryGetComponent(entity_id);
+    if (component == nullptr) {
+      return Error{ "Entity doesn't have this component" };
+    }
+    return component;
+  }
+
+  /**
+   * @brief Call func(const ComponentName&, std::span<const EntityID>) once for every distinct value of a shared
+   * component with the entities that share it. See SharedComponentArray::EachGroup().
+   *
+   * @return Error An error if the component hasn't been registered.
+   */
+  template<typename ComponentName, typename Func> Error EachSharedGroup(Func&& func)
+  {
+    static_assert(is_shared_component_v<ComponentName>);
+    auto comp_array = GetComponentArray<ComponentName>();
+    if (comp_array.Bad()) {
+      return comp_array.Error();
+    }
+    comp_array->EachGroup(func);
+    return Error::OK();
+  }
+
   template<typename ComponentName> Result<size_t> GetComponentCount()
   {
+    if (storage_mode_ == StorageMode::Archetype) {
+      if (!archetypes_.IsRegistered(type_index<ComponentName>::value())) {
+        return Error{ "Component hasn't been registered" };
+      }
+      return archetypes_.ComponentCount<ComponentName>();
+    }
     auto comp_array = GetComponentArray<ComponentName>();
     if (comp_array.Good()) {
       return comp_array->Size();
@@ -102,6 +245,13 @@ public:
 
   template<typename ComponentName> Result<ComponentID<ComponentName>> GetComponentID()
   {
+    if (storage_mode_ == StorageMode::Archetype) {
+      const auto id = type_index<ComponentName>::value();
+      if (!archetypes_.IsRegistered(id)) {
+        return Error{ "Component hasn't been registered" };
+      }
+      return ComponentID<ComponentName>(id);
+    }
     auto comp_array = GetComponentArray<ComponentName>();
     if (comp_array.Good()) {
       return comp_array->GetID();
@@ -110,40 +260,143 @@ public:
     }
   }
 
-  template<typename ComponentName>
-  Result<std::vector<ComponentWrapper<ComponentName>>>& GetComponentVector(ComponentID<ComponentName> component_id)
+  // Only available in StorageMode::Sparse as archetype tables don't store a component type contiguously.
+  template<typename ComponentName> Result<std::span<ComponentName>> GetComponents()
   {
+    static_assert(!is_shared_component_v<ComponentName>, "Shared components aren't stored per entity");
+    if (storage_mode_ == StorageMode::Archetype) {
+      return Error{ "Components aren't stored contiguously in archetype storage" };
+    }
     auto comp_array = GetComponentArray<ComponentName>();
     if (comp_array.Good()) {
-      return comp_array->GetComponentVector();
+      return comp_array->GetComponents();
     } else {
       return comp_array.Error();
     }
   }
 
-  template<typename ComponentName> bool HasComponent(EntityID identifier, ComponentID<ComponentName> component_id)
+  // The entities that own each component in GetComponents(), in the same order. Only available in StorageMode::Sparse.
+  template<typename ComponentName> Result<std::span<const EntityID>> GetComponentEntities()
   {
+    if (storage_mode_ == StorageMode::Archetype) {
+      return Error{ "Components aren't stored contiguously in archetype storage" };
+    }
     auto comp_array = GetComponentArray<ComponentName>();
     if (comp_array.Good()) {
-      return comp_array->HasComponent();
+      return comp_array->GetEntities();
     } else {
       return comp_array.Error();
     }
   }
 
+  template<typename ComponentName> bool HasComponent(EntityID identifier)
+  {
+    if (storage_mode_ == StorageMode::Archetype) {
+      return archetypes_.HasComponent<ComponentName>(identifier);
+    }
+    auto comp_array = GetComponentArray<ComponentName>();
+    return comp_array.Good() && comp_array->HasComponent(identifier);
+  }
+
+  // Create a View over every entity that has all of ComponentNames. Components named const are read only, the view
+  // doesn't mark them changed.
+  template<typename... ComponentNames> Result<View<ComponentNames...>> GetView()
+  {
+    static_assert(!(is_shared_component_v<std::remove_const_t<ComponentNames>> || ...),
+      "Iterate shared components with EachSharedGroup()");
+    if (storage_mode_ == StorageMode::Archetype) {
+      if (!(archetypes_.IsRegistered(type_index<std::remove_const_t<ComponentNames>>::value()) && ...)) {
+        return Error{ "Component hasn't been registered" };
+      }
+      return View<ComponentNames...>(&archetypes_);
+    }
+    auto arrays = std::make_tuple(GetComponentArray<std::remove_const_t<ComponentNames>>()...);
+    return std::apply(
+      [](auto&... comp_arrays) -> Result<View<ComponentNames...>> {
+        if (!(comp_arrays.Good() && ...)) {
+          return Error{ "Component hasn't been registered" };
+        }
+        return View<ComponentNames...>(*comp_arrays...);
+      },
+      arrays);
+  }
+
+  /**
+   * @brief Register an owning Group over ComponentNames. The group keeps the entities that have all of ComponentNames
+   * packed at the front of each array. Only available in StorageMode::Sparse and each component array can only be
+   * owned by one group. Components named const are read only, Group::Each() doesn't mark them changed.
+   *
+   * @return Result<Group<ComponentNames...>*> A handle to the group that lives as long as the ComponentManager.
+   */
+  template<typename... ComponentNames> Result<Group<ComponentNames...>*> RegisterGroup()
+  {
+    static_assert(!(is_shared_component_v<std::remove_const_t<ComponentNames>> || ...),
+      "Shared components can't be owned by a group");
+    if (storage_mode_ == StorageMode::Archetype) {
+      return Error{ "Groups aren't supported with archetype storage" };
+    }
+    auto arrays = std::make_tuple(GetComponentArray<std::remove_const_t<ComponentNames>>()...);
+    return std::apply(
+      [this](auto&... comp_arrays) -> Result<Group<ComponentNames...>*> {
+        if (!(comp_arrays.Good() && ...)) {
+          return Error{ "Component hasn't been registered" };
+        }
+        if ((((*comp_arrays)->GetGroup() != nullptr) || ...)) {
+          return Error{ "Component is already owned by a group" };
+        }
+        auto group = std::make_unique<Group<ComponentNames...>>(*comp_arrays...);
+        auto* handle = group.get();
+        groups_.emplace_back(std::move(group));
+        return handle;
+      },
+      arrays);
+  }
+
+  [[nodiscard]] StorageMode GetStorageMode() const { return storage_mode_; }
+
+  // The tick that component additions and changes are currently stamped with. Starts at 1 so a since tick of 0 sees
+  // every component.
+  [[nodiscard]] uint32_t CurrentTick() const { return tick_; }
+  // Move on to the next tick and return it. Changes made from now on are newer than any earlier tick.
+  uint32_t AdvanceTick() { return ++tick_; }
+
+  // The world's resources, state that isn't owned by an entity.
+  Resources& GetResources() { return resources_; }
+
+  // The archetype tables. Only populated in StorageMode::Archetype.
+  ArchetypeStorage& GetArchetypeStorage() { return archetypes_; }
+
 private:
-  template<typename ComponentName> Result<ComponentArray<ComponentName>*> GetComponentArray()
+  // The array type a component is stored in with StorageMode::Sparse.
+  template<typename ComponentName>
+  using ComponentStorage = std::conditional_t<is_shared_component_v<ComponentName>,
+    SharedComponentArray<ComponentName>,
+    ComponentArray<ComponentName>>;
+
+  template<typename ComponentName> Result<ComponentStorage<ComponentName>*> GetComponentArray()
   {
     auto id = type_index<ComponentName>::value();
-    if (id > component_index_count_) {
+    if (id >= components_.size() || !components_[id]) {
       return Error{ "Component hasn't been registered" };
     }
-    return static_cast<ComponentArray<ComponentName>*>(components_[id].get());
+    return static_cast<ComponentStorage<ComponentName>*>(components_[id].get());
   }
-  // A count to store how "full" or components_ array is.
-  size_t component_index_count_{ 0 };
 
+  StorageMode storage_mode_;
+
+  // Read by every component array through its tick source, so the ComponentManager must not move.
+  uint32_t tick_{ 1 };
+
+  // Indexed by component type index. Used in StorageMode::Sparse.
   std::vector<std::unique_ptr<IComponentArray>> components_;
+
+  // Used in StorageMode::Archetype.
+  ArchetypeStorage archetypes_;
+
+  Resources resources_;
+
+  // Groups registered with RegisterGroup. These must be destroyed before components_.
+  std::vector<std::unique_ptr<IGroup>> groups_;
 };
 
 #endif
\ No newline at end of file
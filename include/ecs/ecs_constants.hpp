@@ -1,11 +1,37 @@
 #ifndef INCLUDE_ECS_CONSTANTS_H_
 #define INCLUDE_ECS_CONSTANTS_H_
 
+#include <cstddef>
 #include <cstdint>
 
 // int32_max assigned to int64_t on purpose. Leaving room incase we need to expand. Do we really need int64_t max
 // entities ever?!
 constexpr int64_t MAX_ENTITY_COUNT = 100000;
 constexpr int64_t MAX_COMPONENT_COUNT = 1024;
+// The most resource types that SystemAccess can track. Resources are indexed by resource_index.
+constexpr size_t MAX_RESOURCE_COUNT = 64;
+// The most ECS worlds (SystemManagers) that can exist at once. Entity handles store the index of their world.
+constexpr uint32_t MAX_WORLD_COUNT = 64;
+// The number of entities covered by a single page of a SparseIndex. Must be a power of 2 so the page lookup is a shift.
+constexpr size_t ENTITY_INDEX_PAGE_SIZE = 4096;
+static_assert((ENTITY_INDEX_PAGE_SIZE & (ENTITY_INDEX_PAGE_SIZE - 1)) == 0);
+// The target size in bytes of one chunk of rows in an archetype table.
+constexpr size_t ARCHETYPE_CHUNK_SIZE = 16384;
+// The size in bytes of a cache line, used to keep per-thread data apart.
+constexpr size_t CACHE_LINE_SIZE = 64;
+// Parallel iteration splits packed ranges into chunks that are a multiple of this many elements. Any multiple of
+// CACHE_LINE_SIZE elements spans whole cache lines, which reduces false sharing between threads writing neighbouring
+// chunks of a packed array. The arrays themselves aren't cache line aligned so a chunk boundary can still split a line.
+constexpr size_t PARALLEL_CHUNK_ALIGNMENT = CACHE_LINE_SIZE;
+// The default fewest elements handed to one thread by a parallel iteration. Smaller ranges run on the calling thread.
+constexpr size_t DEFAULT_PARALLEL_MIN_GRAIN = 1024;
+
+// How components are stored.
+// Sparse - One packed ComponentArray per component type. Adding and removing components is cheap.
+// Archetype - Entities with the same set of components share a table. Iterating several components is cheap.
+enum class StorageMode {
+  Sparse,
+  Archetype
+};
 
 #endif
\ No newline at end of file
@@ -1,9 +1,12 @@
 #ifndef INCLUDE_ECS_CONTROLLER_H_
 #define INCLUDE_ECS_CONTROLLER_H_
 
+#include "ecs/command_buffer.hpp"
 #include "ecs/component_manager.hpp"
 #include "ecs/entity.hpp"
 #include "ecs/entity_manager.hpp"
+#include "ecs/job_system.hpp"
+#include "ecs/prefab.hpp"
 #include "ecs/system.hpp"
 #include "ecs/system_manager.hpp"
 #include "ecs/system_signature.hpp"
@@ -12,14 +15,17 @@
 
 
 #include <memory>
+#include <tuple>
+#include <vector>
 
 
 class ECSController
 {
 public:
-  ECSController()
-    : component_manager_(std::make_unique<ComponentManager>()), entity_manager_(std::make_unique<EntityManager>()),
-      system_manager_(std::make_unique<SystemManager>(component_manager_.get(), entity_manager_.get()))
+  explicit ECSController(StorageMode storage_mode = StorageMode::Sparse)
+    : component_manager_(std::make_unique<ComponentManager>(storage_mode)), entity_manager_(std::make_unique<EntityManager>()),
+      job_system_(std::make_unique<JobSystem>()),
+      system_manager_(std::make_unique<SystemManager>(component_manager_.get(), entity_manager_.get(), job_system_.get()))
   {}
 
   Result<Entity> CreateEntity()
@@ -28,7 +34,84 @@ public:
     if (entity_id.Bad()) {
       return entity_id.Error();
     }
-    return Entity{ system_manager_.get(), component_manager_.get(), entity_manager_.get(), *entity_id };
+    return Entity{ *entity_id, system_manager_->GetWorldIndex() };
+  }
+
+  // False for the id of an entity that has been destroyed, even if its index has been reused by a new entity.
+  [[nodiscard]] bool IsAlive(EntityID entity_id) const { return entity_manager_->IsAlive(entity_id); }
+
+  /**
+   * @brief Create count entities that all start with a copy of each of components. The ids are reserved in one block,
+   * each component array is grown once and the entity sets that want the new entities are found once, which is much
+   * faster than creating the entities and adding their components one at a time.
+   *
+   * @param count The number of entities to create.
+   * @param components The starting value of each component.
+   * @return Result<std::vector<Entity>> The new entities, or an error if a component isn't registered or there aren't
+   * enough entity ids left. No entities are created on error.
+   */
+  template<typename... ComponentNames>
+  [[nodiscard]] Result<std::vector<Entity>> CreateEntities(size_t count, const ComponentNames&... components)
+  {
+    Prefab<ComponentNames...> prefab(components...);
+    return Instantiate(prefab, count);
+  }
+
+  // Capture the ComponentNames of an existing entity as a prefab. Returns an error if the entity is missing one.
+  template<typename... ComponentNames> [[nodiscard]] Result<Prefab<ComponentNames...>> CreatePrefab(Entity entity)
+  {
+    auto components = std::make_tuple(GetPrefabComponent<ComponentNames>(entity)...);
+    return std::apply(
+      [](auto&... component) -> Result<Prefab<ComponentNames...>> {
+        if (!(component.Good() && ...)) {
+          return Error{ "Entity doesn't have every prefab component" };
+        }
+        return Prefab<ComponentNames...>(**component...);
+      },
+      components);
+  }
+
+  /**
+   * @brief Create count copies of a prefab. The entity sets that want the prefab's signature are cached in the prefab so
+   * later instantiations go straight to inserting the new entities.
+   *
+   * @param prefab The components and values of every new entity.
+   * @param count The number of entities to create.
+   * @return Result<std::vector<Entity>> The new entities, or an error if a component isn't registered or there aren't
+   * enough entity ids left. No entities are created on error.
+   */
+  template<typename... ComponentNames>
+  [[nodiscard]] Result<std::vector<Entity>> Instantiate(Prefab<ComponentNames...>& prefab, size_t count)
+  {
+    auto entity_ids = entity_manager_->CreateEntities(count);
+    if (entity_ids.Bad()) {
+      return entity_ids.Error();
+    }
+    auto err = std::apply(
+      [this, &entity_ids](const auto&... components) {
+        return component_manager_->AddComponents<ComponentNames...>(*entity_ids, components...);
+      },
+      prefab.components_);
+    if (err.Bad()) {
+      for (const auto entity_id : *entity_ids) {
+        entity_manager_->DestroyEntity(entity_id);
+      }
+      return err;
+    }
+    const auto world = system_manager_->GetWorldIndex();
+    const auto generation = system_manager_->GetGeneration();
+    if (prefab.generation_ != generation || prefab.entity_set_count_ != system_manager_->EntitySetCount()) {
+      system_manager_->FindEntitySets(prefab.signature_, prefab.entity_sets_);
+      prefab.generation_ = generation;
+      prefab.entity_set_count_ = system_manager_->EntitySetCount();
+    }
+    system_manager_->EntitiesCreated(*entity_ids, prefab.signature_, prefab.entity_sets_);
+    std::vector<Entity> entities;
+    entities.reserve(count);
+    for (const auto entity_id : *entity_ids) {
+      entities.push_back(Entity{ entity_id, world });
+    }
+    return entities;
   }
 
   template<typename ComponentName> [[nodiscard]] Error RegisterComponent()
@@ -47,6 +130,71 @@ public:
     return system_manager_->GetSystem(system_id);
   }
 
+  // Declare the components a system reads and writes so UpdateSystems() can run it alongside other systems.
+  template<typename SystemName> void SetSystemAccess(SystemID<SystemName> system_id, const SystemAccess& access)
+  {
+    system_manager_->SetSystemAccess(system_id, access);
+  }
+
+  // Construct the resource of type ResourceName from args, replacing the existing one. Must not be called while
+  // systems are updating.
+  template<typename ResourceName, typename... Args> ResourceName& SetResource(Args&&... args)
+  {
+    return component_manager_->GetResources().Set<ResourceName>(std::forward<Args>(args)...);
+  }
+
+  // The resource of type ResourceName or nullptr if it hasn't been set.
+  template<typename ResourceName> [[nodiscard]] ResourceName* GetResource() const
+  {
+    return component_manager_->GetResources().Get<ResourceName>();
+  }
+
+  template<typename ResourceName> void RemoveResource() { component_manager_->GetResources().Remove<ResourceName>(); }
+
+  // Register an Observer of the entities that have all of ComponentNames. See SystemManager::RegisterObserver().
+  template<typename... ComponentNames> [[nodiscard]] Result<Observer*> RegisterObserver()
+  {
+    return system_manager_->RegisterObserver<ComponentNames...>();
+  }
+
+  [[nodiscard]] Result<Observer*> RegisterObserver(const SystemSignature& signature)
+  {
+    return system_manager_->RegisterObserver(signature);
+  }
+
+  // Update every registered system, running systems that don't conflict at the same time.
+  void UpdateSystems(const float& delta_time) { system_manager_->UpdateSystems(delta_time, *job_system_); }
+
+  // The job system shared by system scheduling and parallel iteration. Its worker threads are started by the first job.
+  [[nodiscard]] JobSystem& GetJobSystem() { return *job_system_; }
+
+  template<typename... ComponentNames> [[nodiscard]] Result<View<ComponentNames...>> GetView()
+  {
+    return component_manager_->GetView<ComponentNames...>();
+  }
+
+  template<typename... ComponentNames> [[nodiscard]] Result<Group<ComponentNames...>*> RegisterGroup()
+  {
+    return component_manager_->RegisterGroup<ComponentNames...>();
+  }
+
+  // Create a CommandBuffer to record structural changes that are applied when it's flushed.
+  [[nodiscard]] CommandBuffer CreateCommandBuffer()
+  {
+    return CommandBuffer{ system_manager_->GetWorldIndex() };
+  }
+
+  // Create a CommandBuffer for every thread of the job system. Entities can be created and changed from every thread
+  // at once through its own buffer, then each buffer is flushed from one thread.
+  [[nodiscard]] PerThread<CommandBuffer> CreatePerThreadCommandBuffers()
+  {
+    PerThread<CommandBuffer> command_buffers(*job_system_);
+    command_buffers.ForEach([this](CommandBuffer& command_buffer) {
+      command_buffer.SetWorld(system_manager_->GetWorldIndex());
+    });
+    return command_buffers;
+  }
+
   [[nodiscard]] uint64_t EntityCount() const { return entity_manager_->EntityCount(); }
 
   template<typename ComponentName>
@@ -56,9 +204,29 @@ public:
   }
 
 private:
+  // The value of an entity's component, or the shared instance if it's a tag the entity has.
+  template<typename ComponentName> static Result<const ComponentName*> GetPrefabComponent(Entity entity)
+  {
+    if constexpr (is_tag_component_v<ComponentName>) {
+      if (!entity.HasComponent<ComponentName>()) {
+        return Error{ "Entity doesn't have this component" };
+      }
+      return &TagInstance<ComponentName>();
+    } else if constexpr (is_shared_component_v<ComponentName>) {
+      return entity.GetSharedComponent<ComponentName>();
+    } else {
+      auto component = entity.GetComponent<ComponentName>();
+      if (component.Bad()) {
+        return component.Error();
+      }
+      return *component;
+    }
+  }
+
   // Create these all on the heap because they could be quite large
   std::unique_ptr<ComponentManager> component_manager_;
   std::unique_ptr<EntityManager> entity_manager_;
+  std::unique_ptr<JobSystem> job_system_;
   std::unique_ptr<SystemManager> system_manager_;
 };
 
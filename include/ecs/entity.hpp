@@ -1,30 +1,77 @@
 #ifndef INCLUDE_ECS_ENTITY_HPP_
 #define INCLUDE_ECS_ENTITY_HPP_
 
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <type_traits>
+
 #include "ecs/component_array.hpp"
 #include "ecs/component_manager.hpp"
+#include "ecs/ecs_constants.hpp"
 #include "ecs/entity_manager.hpp"
 #include "ecs/system_manager_interface.hpp"
+#include "result.hpp"
+
+// The managers that Entity handles route their operations through.
+struct EntityWorld
+{
+  ISystemManager* system_manager{ nullptr };
+  ComponentManager* component_manager{ nullptr };
+  EntityManager* entity_manager{ nullptr };
+};
+
+// A table of the live worlds so an Entity only has to store a small index instead of pointers to every manager. Each
+// SystemManager registers its world on construction and unregisters it on destruction.
+class EntityWorlds
+{
+public:
+  // The world index of anything that hasn't been bound to a world yet. Using it is a bug.
+  static constexpr uint32_t INVALID_WORLD = std::numeric_limits<uint32_t>::max();
 
+  // Register a world and return its index. At most MAX_WORLD_COUNT worlds can be registered at once, registering
+  // another terminates the program.
+  static uint32_t Register(const EntityWorld& world);
+  static void Unregister(uint32_t world_index);
+  [[nodiscard]] static const EntityWorld& Get(uint32_t world_index)
+  {
+    assertm(world_index < MAX_WORLD_COUNT, "Using a world index that was never bound to a world");
+    return worlds_[world_index];
+  }
 
-// A convenience class for handling an Entity. It shouldn't hold any state other than an EntityID
+private:
+  static std::array<EntityWorld, MAX_WORLD_COUNT> worlds_;
+  // Guards registering and unregistering. Get() doesn't lock, a world's slot only changes while nothing uses it.
+  static std::mutex mutex_;
+  static std::array<bool, MAX_WORLD_COUNT> used_;
+};
+
+// A convenience class for handling an Entity. It shouldn't hold any state other than an EntityID and the index of the
+// world it belongs to, which keeps it 8 bytes and trivially copyable so containers of entities stay small.
 // We want to be able to add and remove Components from Entities
 class Entity
 {
 public:
   [[nodiscard]] EntityID GetID() const { return id_; }
+  [[nodiscard]] uint32_t GetWorldIndex() const { return world_; }
 
   template<typename ComponentName> [[nodiscard]] Error AddComponent(const ComponentName& component = ComponentName{})
   {
+    return EmplaceComponent<ComponentName>(component);
+  }
+
+  // Construct a component in place from args instead of copying one in. Works with move-only components.
+  template<typename ComponentName, typename... Args> [[nodiscard]] Error EmplaceComponent(Args&&... args)
+  {
+    const auto& world = World();
     // Add this entities component to the component manager
-    auto err = component_manager_->AddComponent<ComponentName>(id_, component);
+    auto err = world.component_manager->EmplaceComponent<ComponentName>(id_, std::forward<Args>(args)...);
     if (err.Good()) {
       // Update the system manager with the entities new system signature.
-      SystemSignature& current_signature = system_manager_->GetEntitySystemSignature(id_);
-      auto comp_id = component_manager_->GetComponentID<ComponentName>();
+      auto comp_id = world.component_manager->GetComponentID<ComponentName>();
       if (comp_id.Good()) {
-        current_signature.SetComponent(*comp_id);
-        system_manager_->EntitySignatureChanged(id_, current_signature);
+        world.system_manager->EntityComponentAdded(id_, (*comp_id).Get());
       } else {
         err = comp_id.Error();
       }
@@ -34,15 +81,14 @@ public:
 
   template<typename ComponentName> [[nodiscard]] Error RemoveComponent()
   {
+    const auto& world = World();
     // Remove this entities component from the component manager
-    auto err = component_manager_->RemoveComponent<ComponentName>(id_);
+    auto err = world.component_manager->RemoveComponent<ComponentName>(id_);
     if (err.Good()) {
       // Update the system manager with the entities new system signature
-      SystemSignature current_signature = system_manager_->GetEntitySystemSignature(id_);
-      auto comp_id = component_manager_->GetComponentID<ComponentName>();
+      auto comp_id = world.component_manager->GetComponentID<ComponentName>();
       if (comp_id.Good()) {
-        current_signature.ResetComponent(*comp_id);
-        system_manager_->EntitySignatureChanged(id_, current_signature);
+        world.system_manager->EntityComponentRemoved(id_, (*comp_id).Get());
       } else {
         err = comp_id.Error();
       }
@@ -50,16 +96,79 @@ public:
     return err;
   }
 
+  /**
+   * @brief Add several components at once. Every component is written to storage first and then the entity's
+   * signature is updated once, so the systems only re-test the entity once and never see it with some of the
+   * components. Nothing is added if any component hasn't been registered.
+   *
+   * @param components The values of the components, which must be distinct types.
+   */
+  template<typename... ComponentNames> [[nodiscard]] Error AddComponents(const ComponentNames&... components)
+  {
+    const auto& world = World();
+    if (!(world.component_manager->GetComponentID<ComponentNames>().Good() && ...)) {
+      return Error{ "Component hasn't been registered" };
+    }
+    // One entity gains nothing from the batch path, so emplace each component on its own.
+    (world.component_manager->EmplaceComponent<ComponentNames>(id_, components), ...);
+    SystemSignature signature = world.system_manager->GetEntitySystemSignature(id_);
+    signature.SetComponent<ComponentNames...>();
+    world.system_manager->EntitySignatureChanged(id_, signature);
+    return Error::OK();
+  }
+
+  // Remove several components at once with a single signature update. Nothing is removed if any component hasn't been
+  // registered.
+  template<typename... ComponentNames> [[nodiscard]] Error RemoveComponents()
+  {
+    const auto& world = World();
+    auto err = world.component_manager->RemoveComponents<ComponentNames...>(id_);
+    if (err.Good()) {
+      SystemSignature signature = world.system_manager->GetEntitySystemSignature(id_);
+      signature.ResetComponent<ComponentNames...>();
+      world.system_manager->EntitySignatureChanged(id_, signature);
+    }
+    return err;
+  }
+
+  // Reading doesn't mark the component changed, write through GetComponentMut(). Not available for tag components, use
+  // HasComponent().
   template<typename ComponentName> [[nodiscard]] Result<ComponentName*> GetComponent() const
   {
-    return component_manager_->GetComponent<ComponentName>(id_);
+    return World().component_manager->GetComponent<ComponentName>(id_);
   }
 
+  // Get a component to write to, marking it changed. See ComponentManager::GetComponentMut().
+  template<typename ComponentName> [[nodiscard]] Result<ComponentName*> GetComponentMut() const
+  {
+    return World().component_manager->GetComponentMut<ComponentName>(id_);
+  }
+
+  // Get the value of a shared component, see is_shared_component_v.
+  template<typename ComponentName> [[nodiscard]] Result<const ComponentName*> GetSharedComponent() const
+  {
+    return World().component_manager->GetSharedComponent<ComponentName>(id_);
+  }
+
+  template<typename ComponentName> [[nodiscard]] bool HasComponent() const
+  {
+    return World().component_manager->HasComponent<ComponentName>(id_);
+  }
+
+  // False once the entity has been destroyed, even if its index has been reused by a new entity.
+  [[nodiscard]] bool IsAlive() const { return World().entity_manager->IsAlive(id_); }
+
+  // Destroy the entity. Does nothing if it has already been destroyed.
   void Destroy() const
   {
-    component_manager_->EntityDestroyed(id_);
-    system_manager_->EntityDestroyed(id_);
-    entity_manager_->DestroyEntity(id_);
+    const auto& world = World();
+    if (!world.entity_manager->IsAlive(id_)) {
+      return;
+    }
+    // Only the component arrays and entity sets that reference the entity's components need to know.
+    world.component_manager->EntityDestroyed(id_, world.system_manager->GetEntitySystemSignature(id_));
+    world.system_manager->EntityDestroyed(id_);
+    world.entity_manager->DestroyEntity(id_);
   }
 
   void MoveEntity(Entity*& other)
@@ -69,29 +178,27 @@ public:
     other = static_cast<Entity*>(mem);
   }
 
-  bool operator==(const Entity& rhs) const { return rhs.id_ == this->id_; }
+  bool operator==(const Entity& rhs) const { return rhs.id_ == this->id_ && rhs.world_ == this->world_; }
 
 private:
+  friend class CommandBuffer;
   friend class ECSController;
+  friend class EntitySet;
   friend class SystemManager;
-  Entity(ISystemManager* system_manager,
-    ComponentManager* component_manager,
-    EntityManager* entity_manager,
-    EntityID entity_id)
-    : id_(entity_id), system_manager_(system_manager), component_manager_(component_manager),
-      entity_manager_(entity_manager)
-  {}
-  Entity(EntityID id) : id_(id) {}
+  Entity(EntityID entity_id, uint32_t world_index) : id_(entity_id), world_(world_index) {}
+  [[nodiscard]] const EntityWorld& World() const { return EntityWorlds::Get(world_); }
   EntityID id_;
-  ISystemManager* system_manager_;
-  ComponentManager* component_manager_;
-  EntityManager* entity_manager_;
+  uint32_t world_;
 };
+static_assert(sizeof(Entity) == 8 && std::is_trivially_copyable_v<Entity>);
 
 namespace std {
 template<> struct hash<Entity>
 {
-  uint64_t operator()(const Entity& id) const noexcept { return id.GetID().Get(); }
+  uint64_t operator()(const Entity& id) const noexcept
+  {
+    return uint64_t{ id.GetWorldIndex() } << 32 | id.GetID().Get();
+  }
 };
 }// namespace std
 
@@ -101,7 +208,7 @@ template<> struct ankerl::unordered_dense::hash<Entity>
 
   [[nodiscard]] auto operator()(Entity const& x) const noexcept -> uint64_t
   {
-    return detail::wyhash::hash(x.GetID().Get());
+    return detail::wyhash::hash(uint64_t{ x.GetWorldIndex() } << 32 | x.GetID().Get());
   }
 };
 
@@ -1,21 +1,73 @@
 #ifndef INCLUE_ECS_ENTITY_MANAGER_H_
 #define INCLUE_ECS_ENTITY_MANAGER_H_
 
-#include <queue>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <vector>
 
+#include "ecs/ecs_constants.hpp"
 #include "ids.hpp"
 #include "result.hpp"
 
+// Hands out entity ids and recycles the ids of destroyed entities.
+// CreateEntity() and DestroyEntity() are lock free and can be called from any number of threads at once. Fresh ids come
+// from an atomic counter and destroyed ids go on a lock free stack, so creating and destroying entities on worker
+// threads doesn't need to go through one thread. Components should then be attached at a sync point, for example
+// through a CommandBuffer per thread.
+// Ids are generational: every destroy bumps the version of the id's index, so a stale id kept after its entity was
+// destroyed is never mistaken for the entity that reuses the index. An index whose version reaches
+// EntityID::VERSION_MASK is retired for good rather than wrapped. Use IsAlive() to check an id before using it.
 class EntityManager
 {
 public:
+  EntityManager() = default;
+  EntityManager(const EntityManager&) = delete;
+  EntityManager& operator=(const EntityManager&) = delete;
+  ~EntityManager();
+
   Result<EntityID> CreateEntity();
+  // Create count entities at once. Destroyed ids are reused first and the rest are reserved as one block of fresh ids.
+  // Either every entity is created or, if there aren't enough ids left, none are.
+  Result<std::vector<EntityID>> CreateEntities(size_t count);
+  // Destroy an entity. Destroying a stale id, for example destroying the same entity twice, does nothing.
   void DestroyEntity(EntityID entity_id);
+  // True if entity_id was created and its entity hasn't been destroyed since.
+  [[nodiscard]] bool IsAlive(EntityID entity_id) const;
   [[nodiscard]] uint64_t EntityCount() const;
 
 private:
-  size_t entity_count_{ 1 };
-  std::queue<size_t> free_slots_;
+  static_assert(MAX_ENTITY_COUNT <= EntityID::INDEX_MASK, "Entity indices must fit in the index bits of an EntityID");
+  static constexpr size_t PAGE_COUNT = (MAX_ENTITY_COUNT + ENTITY_INDEX_PAGE_SIZE) / ENTITY_INDEX_PAGE_SIZE;
+  // Id 0 is never handed out so it marks the end of the free list.
+  static constexpr uint32_t END_OF_FREE_LIST = 0;
+  // The state of an index that has been destroyed at least once. An index without a slot has version 0.
+  struct Slot
+  {
+    std::atomic<uint32_t> next_free{ END_OF_FREE_LIST };
+    std::atomic<uint32_t> version{ 0 };
+  };
+  using SlotPage = std::array<Slot, ENTITY_INDEX_PAGE_SIZE>;
+
+  // Pop a destroyed id off the free list, or nullopt if it's empty.
+  std::optional<EntityID> PopFree();
+  // Push an index onto the free list.
+  void PushFree(uint32_t index);
+  // The slot of an index, allocating its page if needed.
+  Slot& GetSlot(uint32_t index);
+  // The current version of an index.
+  [[nodiscard]] uint32_t GetVersion(uint32_t index) const;
+
+  // The next id that has never been handed out.
+  std::atomic<uint64_t> next_id_{ 1 };
+  // The top of the free list in the low 32 bits and a tag in the high 32 bits. The tag changes on every push and pop
+  // so a pop can't succeed against a head that was popped and pushed back in the meantime (the ABA problem).
+  std::atomic<uint64_t> free_head_{ END_OF_FREE_LIST };
+  std::atomic<uint64_t> live_count_{ 0 };
+  // The free list links and versions, allocated a page at a time as ids are first destroyed.
+  std::array<std::atomic<SlotPage*>, PAGE_COUNT> slot_pages_{};
 };
 
-#endif
\ No newline at end of file
+#endif
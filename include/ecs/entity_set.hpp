@@ -0,0 +1,153 @@
+#ifndef INCLUDE_ECS_ENTITY_SET_HPP_
+#define INCLUDE_ECS_ENTITY_SET_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <span>
+#include <vector>
+
+#include "ecs/entity.hpp"
+#include "ecs/sparse_index.hpp"
+#include "ids.hpp"
+
+// A packed sparse set of entities.
+// Entities are stored as 32-bit ids in a contiguous array with a SparseIndex mapping each entity to its position, so
+// insert, erase and contains are O(1) and iteration is a linear walk. Iterating yields Entity handles of the world the
+// set was given.
+// Erasing while iterating is not supported.
+class EntitySet
+{
+public:
+  class Iterator
+  {
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = Entity;
+    using difference_type = std::ptrdiff_t;
+    using pointer = void;
+    using reference = Entity;
+
+    Iterator() = default;
+    Iterator(const EntitySet* set, size_t index) : set_(set), index_(index) {}
+
+    Entity operator*() const { return set_->MakeEntity(set_->dense_[index_]); }
+    Iterator& operator++()
+    {
+      ++index_;
+      return *this;
+    }
+    Iterator operator++(int)
+    {
+      Iterator previous = *this;
+      ++index_;
+      return previous;
+    }
+    bool operator==(const Iterator& rhs) const { return index_ == rhs.index_; }
+
+  private:
+    const EntitySet* set_{ nullptr };
+    size_t index_{ 0 };
+  };
+
+  EntitySet() = default;
+
+  // Insert an entity. Returns false if it was already in the set.
+  bool Insert(EntityID entity_id)
+  {
+    if (sparse_.Contains(entity_id.Index())) {
+      return false;
+    }
+    sparse_.Set(entity_id.Index(), static_cast<uint32_t>(dense_.size()));
+    dense_.push_back(entity_id.Get());
+    return true;
+  }
+
+  // Erase an entity by swapping it with the back of the set. Returns false if it wasn't in the set.
+  bool Erase(EntityID entity_id)
+  {
+    const auto index = sparse_.Get(entity_id.Index());
+    if (index == SparseIndex::INVALID_INDEX || dense_[index] != entity_id.Get()) {
+      return false;
+    }
+    const auto back = dense_.back();
+    dense_[index] = back;
+    sparse_.Set(EntityID(back).Index(), index);
+    dense_.pop_back();
+    sparse_.Reset(entity_id.Index());
+    return true;
+  }
+
+  // False for a stale id of an entity whose index has been reused.
+  [[nodiscard]] bool Contains(EntityID entity_id) const
+  {
+    const auto index = sparse_.Get(entity_id.Index());
+    return index != SparseIndex::INVALID_INDEX && dense_[index] == entity_id.Get();
+  }
+
+  // Reserve room for capacity entities.
+  void Reserve(size_t capacity) { dense_.reserve(capacity); }
+
+  void Clear()
+  {
+    for (const auto entity : dense_) {
+      sparse_.Reset(EntityID(entity).Index());
+    }
+    dense_.clear();
+  }
+
+  /**
+   * @brief Reorder the set to follow order, for example the packed entities of a ComponentArray. Entities in the set
+   * that aren't in order keep their relative order at the back.
+   *
+   * @param order The order to follow.
+   */
+  void RespectOrder(std::span<const EntityID> order)
+  {
+    reordered_.clear();
+    reordered_.reserve(dense_.size());
+    for (const auto& entity_id : order) {
+      const auto index = sparse_.Get(entity_id.Index());
+      if (index == SparseIndex::INVALID_INDEX || dense_[index] != entity_id.Get()) {
+        continue;
+      }
+      reordered_.push_back(entity_id.Get());
+      // Unlink the moved entity so a repeat in order is skipped and the pass below can tell it was moved.
+      sparse_.Reset(entity_id.Index());
+    }
+    for (const auto entity : dense_) {
+      if (sparse_.Get(EntityID(entity).Index()) != SparseIndex::INVALID_INDEX) {
+        reordered_.push_back(entity);
+      }
+    }
+    dense_.swap(reordered_);
+    for (size_t position = 0; position < dense_.size(); ++position) {
+      sparse_.Set(EntityID(dense_[position]).Index(), static_cast<uint32_t>(position));
+    }
+  }
+
+  // The entity at a position in the packed set.
+  [[nodiscard]] Entity operator[](size_t index) const { return MakeEntity(dense_[index]); }
+
+  // The packed entity ids, as returned by EntityID::Get().
+  [[nodiscard]] std::span<const uint32_t> GetIDs() const { return dense_; }
+
+  [[nodiscard]] size_t size() const { return dense_.size(); }
+  [[nodiscard]] bool empty() const { return dense_.empty(); }
+  [[nodiscard]] Iterator begin() const { return Iterator{ this, 0 }; }
+  [[nodiscard]] Iterator end() const { return Iterator{ this, dense_.size() }; }
+
+  // Set the world of the Entity handles handed out when iterating.
+  void SetWorld(uint32_t world_index) { world_ = world_index; }
+
+private:
+  [[nodiscard]] Entity MakeEntity(uint32_t entity) const { return Entity{ EntityID(entity), world_ }; }
+
+  std::vector<uint32_t> dense_;
+  SparseIndex sparse_;
+  // Scratch for RespectOrder(), kept to avoid reallocating.
+  std::vector<uint32_t> reordered_;
+  uint32_t world_{ EntityWorlds::INVALID_WORLD };
+};
+
+#endif// !INCLUDE_ECS_ENTITY_SET_HPP_
@@ -0,0 +1,97 @@
+#ifndef INCLUDE_ECS_ENTITY_SIGNATURE_TABLE_HPP_
+#define INCLUDE_ECS_ENTITY_SIGNATURE_TABLE_HPP_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "ecs/system_signature.hpp"
+
+// The component signature of every entity, stored as one flat entity indexed column.
+// Each row is only as many 64-bit words as the highest component id set so far needs, so a world with up to 64
+// component types pays 8 bytes per entity. Rows are widened in place if a higher component id turns up later.
+class EntitySignatureTable
+{
+public:
+  // The words of an entity's signature. Entities that have never had a component get an empty row.
+  [[nodiscard]] std::span<const uint64_t> Row(size_t entity_index) const
+  {
+    if (entity_index >= entity_count_) {
+      return {};
+    }
+    return { words_.data() + entity_index * words_per_entity_, words_per_entity_ };
+  }
+
+  [[nodiscard]] bool Test(size_t entity_index, size_t component_id) const
+  {
+    const auto row = Row(entity_index);
+    const size_t word = component_id / 64;
+    return word < row.size() && (row[word] >> (component_id % 64) & 1) != 0;
+  }
+
+  void Set(size_t entity_index, size_t component_id)
+  {
+    MutableRow(entity_index, component_id / 64 + 1)[component_id / 64] |= uint64_t{ 1 } << (component_id % 64);
+  }
+
+  void Reset(size_t entity_index, size_t component_id)
+  {
+    if (entity_index < entity_count_ && component_id / 64 < words_per_entity_) {
+      words_[entity_index * words_per_entity_ + component_id / 64] &= ~(uint64_t{ 1 } << (component_id % 64));
+    }
+  }
+
+  // Overwrite an entity's row with signature.
+  void Assign(size_t entity_index, const SystemSignature& signature)
+  {
+    auto row = MutableRow(entity_index, signature.UsedWordCount());
+    std::fill(row.begin(), row.end(), 0);
+    signature.ForEachComponent(
+      [&row](size_t component_id) { row[component_id / 64] |= uint64_t{ 1 } << (component_id % 64); });
+  }
+
+  void Clear(size_t entity_index)
+  {
+    if (entity_index < entity_count_) {
+      std::fill_n(words_.begin() + static_cast<std::ptrdiff_t>(entity_index * words_per_entity_), words_per_entity_, 0);
+    }
+  }
+
+  [[nodiscard]] SystemSignature GetSignature(size_t entity_index) const { return SystemSignature{ Row(entity_index) }; }
+
+  [[nodiscard]] size_t WordsPerEntity() const { return words_per_entity_; }
+
+private:
+  std::span<uint64_t> MutableRow(size_t entity_index, size_t word_count)
+  {
+    if (word_count > words_per_entity_) {
+      Widen(word_count);
+    }
+    if (entity_index >= entity_count_) {
+      entity_count_ = std::max(entity_index + 1, entity_count_ * 2);
+      words_.resize(entity_count_ * words_per_entity_);
+    }
+    return { words_.data() + entity_index * words_per_entity_, words_per_entity_ };
+  }
+
+  // Re-layout every row with word_count words.
+  void Widen(size_t word_count)
+  {
+    std::vector<uint64_t> widened(entity_count_ * word_count);
+    for (size_t entity = 0; entity < entity_count_; ++entity) {
+      std::copy_n(words_.begin() + static_cast<std::ptrdiff_t>(entity * words_per_entity_),
+        words_per_entity_,
+        widened.begin() + static_cast<std::ptrdiff_t>(entity * word_count));
+    }
+    words_ = std::move(widened);
+    words_per_entity_ = word_count;
+  }
+
+  std::vector<uint64_t> words_;
+  size_t words_per_entity_{ 1 };
+  size_t entity_count_{ 0 };
+};
+
+#endif// !INCLUDE_ECS_ENTITY_SIGNATURE_TABLE_HPP_
@@ -0,0 +1,104 @@
+#ifndef INCLUDE_ECS_GROUP_HPP_
+#define INCLUDE_ECS_GROUP_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <tuple>
+#include <type_traits>
+
+#include "ecs/component_array.hpp"
+#include "ecs/tag_component.hpp"
+#include "ids.hpp"
+
+// An owning group over ComponentNames.
+// Every entity that has all of ComponentNames is kept packed at the front of each owned ComponentArray, in the same
+// order. Iterating the group is then a plain indexed loop over the arrays with no index lookups at all.
+// The owned arrays keep the group up to date as components are added and removed, each with O(1) swaps.
+// A component array can only be owned by one group.
+// Components that aren't named const are marked changed on every entity Each() visits, so name components the
+// iteration only reads as const, e.g. Group<const Position, Velocity>.
+template<typename... ComponentNames> class Group : public IGroup
+{
+public:
+  static_assert(sizeof...(ComponentNames) > 0, "A group needs at least one component");
+
+  explicit Group(ComponentArray<std::remove_const_t<ComponentNames>>*... arrays) : arrays_(arrays...)
+  {
+    std::apply([this](auto*... comp_arrays) { (comp_arrays->SetGroup(this), ...); }, arrays_);
+    // Pull in any entities that already have all the components.
+    const auto entities = std::get<0>(arrays_)->GetEntities();
+    for (size_t index = 0; index < entities.size(); ++index) {
+      ComponentAdded(entities[index]);
+    }
+  }
+  Group(const Group&) = delete;
+  Group& operator=(const Group&) = delete;
+
+  ~Group() override
+  {
+    std::apply([](auto*... comp_arrays) { (comp_arrays->SetGroup(nullptr), ...); }, arrays_);
+  }
+
+  void ComponentAdded(EntityID entity_id) override
+  {
+    const bool has_all =
+      std::apply([entity_id](auto*... comp_arrays) { return (comp_arrays->HasComponent(entity_id) && ...); }, arrays_);
+    // Entities already in the group sit before size_.
+    if (!has_all || std::get<0>(arrays_)->IndexOf(entity_id) < size_) {
+      return;
+    }
+    std::apply([this, entity_id](
+                 auto*... comp_arrays) { (comp_arrays->Swap(comp_arrays->IndexOf(entity_id), size_), ...); },
+      arrays_);
+    ++size_;
+  }
+
+  void ComponentRemoved(EntityID entity_id) override
+  {
+    // An entity in the group has every owned component at the same position before size_.
+    if (std::get<0>(arrays_)->IndexOf(entity_id) >= size_) {
+      return;
+    }
+    --size_;
+    std::apply([this, entity_id](
+                 auto*... comp_arrays) { (comp_arrays->Swap(comp_arrays->IndexOf(entity_id), size_), ...); },
+      arrays_);
+  }
+
+  [[nodiscard]] size_t Size() const { return size_; }
+
+  /**
+   * @brief Call func(EntityID, ComponentNames&...) for every entity in the group, then mark the group's components
+   * that aren't const changed. Components must not be added or removed from the owned arrays while iterating.
+   */
+  template<typename Func> void Each(Func&& func)
+  {
+    const auto entities = std::get<0>(arrays_)->GetEntities();
+    std::apply(
+      [&](auto*... comp_arrays) {
+        auto data = std::make_tuple(static_cast<ComponentNames*>(comp_arrays->Data())...);
+        std::apply(
+          [&](auto*... components) {
+            for (uint32_t index = 0; index < size_; ++index) {
+              func(entities[index], ComponentAt(components, index)...);
+            }
+          },
+          data);
+        (MarkWritten<ComponentNames>(comp_arrays), ...);
+      },
+      arrays_);
+  }
+
+private:
+  template<typename C> void MarkWritten(ComponentArray<std::remove_const_t<C>>* array) const
+  {
+    if constexpr (!std::is_const_v<C> && !is_tag_component_v<C>) {
+      array->MarkChanged(0, size_);
+    }
+  }
+
+  std::tuple<ComponentArray<std::remove_const_t<ComponentNames>>*...> arrays_;
+  uint32_t size_{ 0 };
+};
+
+#endif// !INCLUDE_ECS_GROUP_HPP_
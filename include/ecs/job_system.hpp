@@ -0,0 +1,230 @@
+#ifndef INCLUDE_ECS_JOB_SYSTEM_HPP_
+#define INCLUDE_ECS_JOB_SYSTEM_HPP_
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "ecs/ecs_constants.hpp"
+#include "ecs/work_stealing_deque.hpp"
+
+class JobCounter;
+
+// A unit of work spawned on a JobSystem.
+struct Job
+{
+  std::function<void()> task;
+  // Decremented once the task has run.
+  JobCounter* counter{ nullptr };
+};
+
+// The number of unfinished jobs spawned with this counter. Waiting on a counter waits for all of those jobs, and jobs
+// can be spawned to only start once a counter reaches zero.
+class JobCounter
+{
+public:
+  JobCounter() = default;
+  JobCounter(const JobCounter&) = delete;
+  JobCounter& operator=(const JobCounter&) = delete;
+
+  [[nodiscard]] bool Done() const { return pending_.load(std::memory_order_acquire) == 0; }
+  [[nodiscard]] uint32_t Pending() const { return pending_.load(std::memory_order_acquire) & ~LOCKED; }
+
+private:
+  friend class JobSystem;
+  // The top bit of pending_ locks continuations_. Keeping the lock in the same word as the count lets the last job
+  // release the lock and finish the counter in one store, so nothing touches the counter once a waiter can see it done
+  // and destroy it.
+  static constexpr uint32_t LOCKED = 1U << 31;
+  std::atomic<uint32_t> pending_{ 0 };
+  // Jobs waiting for this counter to reach zero.
+  std::vector<Job*> continuations_;
+};
+
+// A work stealing job system.
+// Every worker thread, and the thread that created the job system, has its own Chase-Lev deque. Jobs spawned by a
+// thread go on its own deque and idle threads steal from the others. Jobs spawned from any other thread go through a
+// shared queue. Waiting on a JobCounter runs other jobs rather than blocking, so jobs can spawn and wait on more jobs.
+// The workers are started by the first job so an unused job system costs nothing.
+class JobSystem
+{
+public:
+  // worker_count extra threads are started, the thread that creates the job system helps while it waits.
+  explicit JobSystem(size_t worker_count = DefaultWorkerCount());
+  JobSystem(const JobSystem&) = delete;
+  JobSystem& operator=(const JobSystem&) = delete;
+  ~JobSystem();
+
+  // The number of threads that run jobs, including the thread that created the job system.
+  [[nodiscard]] size_t ThreadCount() const { return worker_count_ + 1; }
+
+  // CurrentThreadIndex() of a thread that is neither a worker nor created a job system.
+  static constexpr size_t NOT_A_JOB_THREAD = std::numeric_limits<size_t>::max();
+
+  // The index of the current thread in [0, ThreadCount()). Worker threads are 1 and up and the thread that created the
+  // job system is 0. Any other thread is NOT_A_JOB_THREAD, it has no slot of its own.
+  [[nodiscard]] static size_t CurrentThreadIndex() { return thread_index_; }
+
+  /**
+   * @brief Run task on any thread.
+   *
+   * @param task The work to run.
+   * @param counter Incremented now and decremented once task has run. May be null.
+   */
+  void Spawn(std::function<void()> task, JobCounter* counter = nullptr);
+
+  /**
+   * @brief Run task on any thread once dependency reaches zero. No more jobs should be spawned with dependency once it
+   * could have reached zero.
+   *
+   * @param dependency The counter to wait for.
+   * @param task The work to run.
+   * @param counter Incremented now and decremented once task has run. May be null.
+   */
+  void SpawnAfter(JobCounter& dependency, std::function<void()> task, JobCounter* counter = nullptr);
+
+  // Run other jobs on the calling thread until counter reaches zero. Threads outside the job system just wait.
+  void WaitHelping(const JobCounter& counter);
+
+  /**
+   * @brief Call func(index) for every index in [0, count) spread over the threads. Blocks, running jobs, until every
+   * index has been run. Can be called from inside a job.
+   *
+   * @param count The number of indices to run.
+   * @param func The function to call with each index.
+   */
+  template<typename Func> void ParallelFor(size_t count, Func&& func)
+  {
+    if (count <= 1 || worker_count_ == 0 || !IsJobThread()) {
+      for (size_t index = 0; index < count; ++index) {
+        func(index);
+      }
+      return;
+    }
+    JobCounter counter;
+    for (size_t index = 1; index < count; ++index) {
+      Spawn([&func, index] { func(index); }, &counter);
+    }
+    func(0);
+    WaitHelping(counter);
+  }
+
+  /**
+   * @brief Split [0, count) into chunks and call func(begin, end) for every chunk spread over the threads. Chunks hold at
+   * least min_grain indices and are a multiple of PARALLEL_CHUNK_ALIGNMENT, which reduces false sharing between
+   * neighbouring chunks of a packed array. A range of min_grain or fewer indices runs as one chunk on the calling thread.
+   *
+   * @param count The number of indices to run.
+   * @param min_grain The fewest indices to hand to one thread.
+   * @param func The function to call with each chunk.
+   */
+  template<typename Func> void ParallelForChunks(size_t count, size_t min_grain, Func&& func)
+  {
+    if (count == 0) {
+      return;
+    }
+    // Aim for a few chunks per thread so a slow thread can be balanced out by the others.
+    const size_t target = (count + ThreadCount() * 4 - 1) / (ThreadCount() * 4);
+    size_t chunk_size = std::max({ target, min_grain, size_t{ 1 } });
+    chunk_size = (chunk_size + PARALLEL_CHUNK_ALIGNMENT - 1) / PARALLEL_CHUNK_ALIGNMENT * PARALLEL_CHUNK_ALIGNMENT;
+    const size_t chunk_count = (count + chunk_size - 1) / chunk_size;
+    ParallelFor(chunk_count, [&](size_t chunk) {
+      func(chunk * chunk_size, std::min(count, (chunk + 1) * chunk_size));
+    });
+  }
+
+  [[nodiscard]] static size_t DefaultWorkerCount()
+  {
+    const auto hardware_threads = std::thread::hardware_concurrency();
+    return hardware_threads > 1 ? hardware_threads - 1 : 0;
+  }
+
+private:
+  using JobDeque = WorkStealingDeque<Job>;
+
+  // True on the job system's worker threads and the thread that created it.
+  [[nodiscard]] bool IsJobThread() const
+  {
+    return worker_of_ == this || std::this_thread::get_id() == owner_thread_;
+  }
+  void StartWorkers();
+  void WorkerLoop(size_t thread_index);
+  // Queue a job that is ready to run.
+  void Enqueue(Job* job);
+  // Find a job, from this thread's deque, the shared queue or another thread, and run it. Returns false if there
+  // weren't any jobs.
+  bool TryRunJob();
+  [[nodiscard]] Job* FindJob();
+  void RunJob(Job* job);
+
+  size_t worker_count_;
+  std::thread::id owner_thread_;
+  // One deque per thread, index 0 belongs to the thread that created the job system.
+  std::vector<std::unique_ptr<JobDeque>> deques_;
+  std::vector<std::thread> workers_;
+  std::once_flag workers_started_;
+
+  // Jobs spawned from threads outside the job system.
+  std::mutex shared_mutex_;
+  std::deque<Job*> shared_jobs_;
+  std::atomic<size_t> shared_job_count_{ 0 };
+
+  // Idle workers sleep until a job is queued.
+  std::mutex sleep_mutex_;
+  std::condition_variable wake_;
+  std::atomic<int64_t> queued_jobs_{ 0 };
+  std::atomic<uint32_t> sleeping_workers_{ 0 };
+  std::atomic<bool> stop_{ false };
+
+  static thread_local const JobSystem* worker_of_;
+  static thread_local size_t thread_index_;
+};
+
+// One T per thread of a JobSystem, each on its own cache lines. Useful as scratch space in a parallel iteration, for
+// example to collect results or record changes that are merged once the iteration has finished.
+// Only the job system's threads have a T, so the iteration must be started from the thread that created the job
+// system. Without a job system there is a single T for the one thread that iterates.
+template<typename T> class PerThread
+{
+public:
+  explicit PerThread(const JobSystem& job_system) : slots_(job_system.ThreadCount()), has_job_system_(true) {}
+  explicit PerThread(const JobSystem* job_system)
+    : slots_(job_system != nullptr ? job_system->ThreadCount() : 1), has_job_system_(job_system != nullptr)
+  {}
+
+  // The current thread's T. Asserts on threads outside the job system, they would all share one T.
+  T& Local()
+  {
+    const size_t index = has_job_system_ ? JobSystem::CurrentThreadIndex() : 0;
+    assert(index < slots_.size());
+    return slots_[index].value;
+  }
+
+  // Call func(T&) for every thread's T. Must not be called during a parallel iteration using the Ts.
+  template<typename Func> void ForEach(Func&& func)
+  {
+    for (auto& slot : slots_) {
+      func(slot.value);
+    }
+  }
+
+private:
+  struct alignas(CACHE_LINE_SIZE) Slot
+  {
+    T value{};
+  };
+  std::vector<Slot> slots_;
+  bool has_job_system_;
+};
+
+#endif// !INCLUDE_ECS_JOB_SYSTEM_HPP_
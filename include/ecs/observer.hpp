@@ -0,0 +1,51 @@
+#ifndef INCLUDE_ECS_OBSERVER_HPP_
+#define INCLUDE_ECS_OBSERVER_HPP_
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "ecs/system_signature.hpp"
+#include "ids.hpp"
+
+// Collects the entities that start or stop matching a signature, for keeping an index such as a spatial grid or a name
+// lookup up to date without rescanning every entity.
+// An entity is recorded as added when it gains the last component of the signature, including being created with it,
+// and as removed when it loses one of them or is destroyed. Events are appended to two packed buffers as they happen,
+// there are no callbacks, and the owner drains both buffers in one batch when it suits it.
+// An entity can be in both buffers if it came and went since the last Clear(), and destroyed entities may already have
+// been recycled, so check IsAlive() or HasComponent() for the entity's current state.
+class Observer
+{
+public:
+  explicit Observer(const SystemSignature& signature) : signature_(signature) {}
+  Observer(const Observer&) = delete;
+  Observer& operator=(const Observer&) = delete;
+
+  [[nodiscard]] const SystemSignature& GetSignature() const { return signature_; }
+
+  // The entities that started matching the signature since the last Clear(), in order.
+  [[nodiscard]] std::span<const EntityID> Added() const { return added_; }
+  // The entities that stopped matching the signature since the last Clear(), in order.
+  [[nodiscard]] std::span<const EntityID> Removed() const { return removed_; }
+
+  [[nodiscard]] bool Empty() const { return added_.empty() && removed_.empty(); }
+
+  // Forget the recorded entities. The buffers keep their capacity.
+  void Clear()
+  {
+    added_.clear();
+    removed_.clear();
+  }
+
+private:
+  friend class SystemManager;
+
+  SystemSignature signature_;
+  std::vector<EntityID> added_;
+  std::vector<EntityID> removed_;
+  // The last signature change this observer was tested for, see SystemManager::TrackedEntitySet::stamp.
+  uint64_t stamp_{ 0 };
+};
+
+#endif// !INCLUDE_ECS_OBSERVER_HPP_
@@ -0,0 +1,47 @@
+#ifndef INCLUDE_ECS_PREFAB_HPP_
+#define INCLUDE_ECS_PREFAB_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <tuple>
+#include <vector>
+
+#include "ecs/system_signature.hpp"
+
+// A template for spawning many copies of the same entity, for example an enemy or a particle definition.
+// The component values and their signature are captured once. ECSController::Instantiate() then creates entities in
+// bulk, filling each component array with copies of the values and inserting the batch straight into the entity sets
+// that want the signature. The entity sets are looked up on the first instantiation and reused until a system
+// registers another entity set.
+template<typename... ComponentNames> class Prefab
+{
+public:
+  explicit Prefab(const ComponentNames&... components) : components_(components...)
+  {
+    signature_.SetComponent<ComponentNames...>();
+  }
+
+  // The value a component is given in every new instance.
+  template<typename ComponentName> [[nodiscard]] ComponentName& Get() { return std::get<ComponentName>(components_); }
+  template<typename ComponentName> [[nodiscard]] const ComponentName& Get() const
+  {
+    return std::get<ComponentName>(components_);
+  }
+
+  [[nodiscard]] const std::tuple<ComponentNames...>& GetComponents() const { return components_; }
+  [[nodiscard]] const SystemSignature& GetSignature() const { return signature_; }
+
+private:
+  friend class ECSController;
+
+  std::tuple<ComponentNames...> components_;
+  SystemSignature signature_;
+
+  // The entity sets, as SystemManager tracked set indices, that want signature_. Only valid for the system manager
+  // with generation_ while it has entity_set_count_ entity sets.
+  std::vector<uint32_t> entity_sets_;
+  uint64_t generation_{ 0 };
+  size_t entity_set_count_{ 0 };
+};
+
+#endif// !INCLUDE_ECS_PREFAB_HPP_
@@ -0,0 +1,100 @@
+#ifndef INCLUDE_ECS_RESOURCES_HPP_
+#define INCLUDE_ECS_RESOURCES_HPP_
+
+#include <atomic>
+#include <bitset>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "ecs/ecs_constants.hpp"
+
+namespace internal {
+struct resource_index final
+{
+  [[nodiscard]] static uint32_t next() noexcept
+  {
+    // The first use of a resource can happen on several job system threads at once.
+    static std::atomic<uint32_t> value{};
+    return value.fetch_add(1, std::memory_order_relaxed);
+  }
+};
+}// namespace internal
+
+// A unique, dense index per resource type. Kept apart from type_index so resource indices stay small.
+template<typename Type> struct resource_index final
+{
+  static uint32_t value() noexcept
+  {
+    static const uint32_t value = internal::resource_index::next();
+    return value;
+  }
+  constexpr operator uint32_t() const noexcept { return value(); }
+};
+
+// The set of resource types a system reads or writes, indexed by resource_index.
+using ResourceMask = std::bitset<MAX_RESOURCE_COUNT>;
+
+// World wide state that isn't owned by an entity, for example the physics config, the frame clock or an input
+// snapshot. There's at most one value per type, stored in a slot indexed by resource_index so getting a resource is an
+// index and a pointer load with no entity or index map involved.
+// Resources must not be set or removed while systems are updating, the values themselves can be used from systems
+// that declare access to them in their SystemAccess.
+class Resources
+{
+public:
+  Resources() = default;
+  Resources(const Resources&) = delete;
+  Resources& operator=(const Resources&) = delete;
+
+  // Construct the resource of type T from args, replacing the existing one if there is one.
+  template<typename T, typename... Args> T& Set(Args&&... args)
+  {
+    const auto index = resource_index<T>::value();
+    if (slots_.size() <= index) {
+      slots_.resize(index + 1);
+    }
+    auto slot = std::make_unique<Slot<T>>(std::forward<Args>(args)...);
+    T& value = slot->value;
+    slots_[index] = std::move(slot);
+    return value;
+  }
+
+  // The resource of type T or nullptr if it hasn't been set.
+  template<typename T> [[nodiscard]] T* Get() const
+  {
+    const auto index = resource_index<T>::value();
+    if (index >= slots_.size() || !slots_[index]) {
+      return nullptr;
+    }
+    return &static_cast<Slot<T>*>(slots_[index].get())->value;
+  }
+
+  template<typename T> [[nodiscard]] bool Contains() const { return Get<T>() != nullptr; }
+
+  template<typename T> void Remove()
+  {
+    const auto index = resource_index<T>::value();
+    if (index < slots_.size()) {
+      slots_[index].reset();
+    }
+  }
+
+private:
+  struct ISlot
+  {
+    virtual ~ISlot() = default;
+  };
+
+  template<typename T> struct Slot : ISlot
+  {
+    template<typename... Args> explicit Slot(Args&&... args) : value(std::forward<Args>(args)...) {}
+    T value;
+  };
+
+  // Indexed by resource_index.
+  std::vector<std::unique_ptr<ISlot>> slots_;
+};
+
+#endif// !INCLUDE_ECS_RESOURCES_HPP_
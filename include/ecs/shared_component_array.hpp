@@ -0,0 +1,219 @@
+#ifndef INCLUDE_ECS_SHARED_COMPONENT_ARRAY_HPP_
+#define INCLUDE_ECS_SHARED_COMPONENT_ARRAY_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include "ankerl/unordered_dense.h"
+
+#include "ecs/component_array.hpp"
+#include "ecs/sparse_index.hpp"
+#include "ids.hpp"
+
+// Opt a component type into shared storage by specializing this before the component is first used:
+//   template<> inline constexpr bool is_shared_component_v<Material> = true;
+// A shared component needs operator== and a std::hash (or ankerl::unordered_dense::hash) specialization.
+template<typename T> inline constexpr bool is_shared_component_v = false;
+
+// Storage for a component that many entities have identical values of, for example mesh or material descriptors.
+// Every distinct value is stored once in a pool and each entity only stores the 32-bit index of its value. Values are
+// found through a hash set of indices so adding a component that's equal to an existing value just bumps its reference
+// count, and a value is destroyed when its last entity loses it.
+// Values are immutable once shared, to give one entity a different value add the component again. Only available in
+// StorageMode::Sparse.
+template<typename T> class SharedComponentArray : public IComponentArray
+{
+public:
+  explicit SharedComponentArray(ComponentID<T> id)
+    : lookup_(0, ValueHash{ &values_ }, ValueEqual{ &values_ }), id_(id)
+  {}
+  // The lookup refers to values_ so the array can't be copied or moved.
+  SharedComponentArray(const SharedComponentArray&) = delete;
+  SharedComponentArray& operator=(const SharedComponentArray&) = delete;
+  ~SharedComponentArray() override = default;
+
+  void AddComponent(EntityID entity_id, const T& component) { EmplaceComponent(entity_id, component); }
+
+  // Give an entity the value built from args, replacing the value it had.
+  template<typename... Args> void EmplaceComponent(EntityID entity_id, Args&&... args)
+  {
+    const uint32_t value_index = Acquire(T(std::forward<Args>(args)...), 1);
+    const auto index = entity_index_map_.Get(entity_id.Index());
+    if (index != SparseIndex::INVALID_INDEX) {
+      Release(value_indices_[index]);
+      value_indices_[index] = value_index;
+      return;
+    }
+    entity_index_map_.Set(entity_id.Index(), static_cast<uint32_t>(entities_.size()));
+    entities_.push_back(entity_id);
+    value_indices_.push_back(value_index);
+  }
+
+  // Give every entity in entity_ids the same value. The value is looked up in the pool once for the whole batch.
+  void AddComponents(std::span<const EntityID> entity_ids, const T& component)
+  {
+    if (entity_ids.empty()) {
+      return;
+    }
+    const uint32_t value_index = Acquire(T(component), static_cast<uint32_t>(entity_ids.size()));
+    entities_.reserve(entities_.size() + entity_ids.size());
+    value_indices_.reserve(value_indices_.size() + entity_ids.size());
+    for (const auto entity_id : entity_ids) {
+      const auto index = entity_index_map_.Get(entity_id.Index());
+      if (index != SparseIndex::INVALID_INDEX) {
+        Release(value_indices_[index]);
+        value_indices_[index] = value_index;
+        continue;
+      }
+      entity_index_map_.Set(entity_id.Index(), static_cast<uint32_t>(entities_.size()));
+      entities_.push_back(entity_id);
+      value_indices_.push_back(value_index);
+    }
+  }
+
+  void RemoveComponent(EntityID entity_id) override
+  {
+    const auto index = entity_index_map_.Get(entity_id.Index());
+    if (index == SparseIndex::INVALID_INDEX) {
+      return;
+    }
+    Release(value_indices_[index]);
+    const auto back_entity = entities_.back();
+    entity_index_map_.Set(back_entity.Index(), index);
+    entities_[index] = back_entity;
+    value_indices_[index] = value_indices_.back();
+    entities_.pop_back();
+    value_indices_.pop_back();
+    entity_index_map_.Reset(entity_id.Index());
+  }
+
+  [[nodiscard]] bool HasComponent(EntityID entity_id) const { return entity_index_map_.Contains(entity_id.Index()); }
+
+  // The number of entities with the component.
+  [[nodiscard]] size_t Size() const { return entities_.size(); }
+
+  // The number of distinct values in use.
+  [[nodiscard]] size_t ValueCount() const { return lookup_.size(); }
+
+  // Get the value of an entity's component or nullptr if the entity doesn't have one.
+  [[nodiscard]] const T* TryGetComponent(EntityID entity_id) const
+  {
+    const auto index = entity_index_map_.Get(entity_id.Index());
+    return index != SparseIndex::INVALID_INDEX ? &*values_[value_indices_[index]] : nullptr;
+  }
+
+  // The entities with the component, packed.
+  [[nodiscard]] std::span<const EntityID> GetEntities() const { return entities_; }
+
+  // The index of each entity's value in the same order as GetEntities(). Use GetValue() to read a value.
+  [[nodiscard]] std::span<const uint32_t> GetValueIndices() const { return value_indices_; }
+
+  [[nodiscard]] const T& GetValue(uint32_t value_index) const { return *values_[value_index]; }
+
+  /**
+   * @brief Call func(const T&, std::span<const EntityID>) once for every distinct value with all of the entities that
+   * share it, so work can be batched per value, for example one draw call per material. The entities are bucketed by
+   * value index, linear in the number of entities and values.
+   * Components must not be added or removed while iterating.
+   */
+  template<typename Func> void EachGroup(Func&& func)
+  {
+    group_offsets_.assign(values_.size() + 1, 0);
+    for (const auto value_index : value_indices_) {
+      ++group_offsets_[value_index + 1];
+    }
+    for (size_t value_index = 0; value_index < values_.size(); ++value_index) {
+      group_offsets_[value_index + 1] += group_offsets_[value_index];
+    }
+    grouped_entities_.assign(entities_.size(), EntityID{ 0 });
+    // Place each entity at the next free position of its group, using the group's end as the cursor.
+    for (size_t index = 0; index < entities_.size(); ++index) {
+      grouped_entities_[group_offsets_[value_indices_[index]]++] = entities_[index];
+    }
+    uint32_t begin = 0;
+    for (size_t value_index = 0; value_index < values_.size(); ++value_index) {
+      const uint32_t end = group_offsets_[value_index];
+      if (end != begin) {
+        func(*values_[value_index], std::span<const EntityID>{ grouped_entities_.data() + begin, end - begin });
+      }
+      begin = end;
+    }
+  }
+
+  ComponentID<T> GetID() { return id_; }
+
+private:
+  // Hash and compare values_ slots by their value, and look values up without adding them to the pool first.
+  struct ValueHash
+  {
+    using is_transparent = void;
+    const std::vector<std::optional<T>>* values;
+    [[nodiscard]] uint64_t operator()(uint32_t value_index) const { return (*this)(*(*values)[value_index]); }
+    [[nodiscard]] uint64_t operator()(const T& value) const { return ankerl::unordered_dense::hash<T>{}(value); }
+  };
+  struct ValueEqual
+  {
+    using is_transparent = void;
+    const std::vector<std::optional<T>>* values;
+    [[nodiscard]] bool operator()(uint32_t lhs, uint32_t rhs) const { return lhs == rhs; }
+    [[nodiscard]] bool operator()(const T& lhs, uint32_t rhs) const { return lhs == *(*values)[rhs]; }
+    [[nodiscard]] bool operator()(uint32_t lhs, const T& rhs) const { return *(*values)[lhs] == rhs; }
+  };
+
+  // Find or add value in the pool and add count references to it.
+  uint32_t Acquire(T&& value, uint32_t count)
+  {
+    const auto iter = lookup_.find(value);
+    if (iter != lookup_.end()) {
+      ref_counts_[*iter] += count;
+      return *iter;
+    }
+    uint32_t value_index = 0;
+    if (!free_values_.empty()) {
+      value_index = free_values_.back();
+      free_values_.pop_back();
+      values_[value_index].emplace(std::move(value));
+      ref_counts_[value_index] = count;
+    } else {
+      value_index = static_cast<uint32_t>(values_.size());
+      values_.emplace_back(std::move(value));
+      ref_counts_.push_back(count);
+    }
+    lookup_.insert(value_index);
+    return value_index;
+  }
+
+  void Release(uint32_t value_index)
+  {
+    if (--ref_counts_[value_index] != 0) {
+      return;
+    }
+    // Erase while the value is still there to hash.
+    lookup_.erase(value_index);
+    values_[value_index].reset();
+    free_values_.push_back(value_index);
+  }
+
+  // Maps an entity to its position in entities_ and value_indices_.
+  SparseIndex entity_index_map_;
+  std::vector<EntityID> entities_;
+  std::vector<uint32_t> value_indices_;
+
+  // The value pool. Slots of released values are empty and reused by the next new value.
+  std::vector<std::optional<T>> values_;
+  std::vector<uint32_t> ref_counts_;
+  std::vector<uint32_t> free_values_;
+  ankerl::unordered_dense::set<uint32_t, ValueHash, ValueEqual> lookup_;
+
+  // Scratch for EachGroup().
+  std::vector<uint32_t> group_offsets_;
+  std::vector<EntityID> grouped_entities_;
+
+  ComponentID<T> id_;
+};
+
+#endif// !INCLUDE_ECS_SHARED_COMPONENT_ARRAY_HPP_
@@ -0,0 +1,97 @@
+#ifndef INCLUDE_ECS_SPARSE_INDEX_HPP_
+#define INCLUDE_ECS_SPARSE_INDEX_HPP_
+
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include "ecs/ecs_constants.hpp"
+
+// Maps an entity index to a 32-bit index into a packed array.
+// The map is split into fixed size pages that are only allocated once an entity in that page's range is inserted. A
+// ComponentArray that only a handful of entities use therefore only pays for the pages those entities live in rather
+// than a full MAX_ENTITY_COUNT sized array.
+class SparseIndex
+{
+public:
+  static constexpr uint32_t INVALID_INDEX = std::numeric_limits<uint32_t>::max();
+
+  SparseIndex() = default;
+  SparseIndex(SparseIndex&&) = default;
+  SparseIndex& operator=(SparseIndex&&) = default;
+  SparseIndex(const SparseIndex& other) { *this = other; }
+  SparseIndex& operator=(const SparseIndex& other)
+  {
+    if (this == &other) {
+      return *this;
+    }
+    pages_.clear();
+    pages_.reserve(other.pages_.size());
+    for (const auto& page : other.pages_) {
+      pages_.emplace_back(page ? std::make_unique<Page>(*page) : nullptr);
+    }
+    return *this;
+  }
+
+  // Get the packed index of an entity or INVALID_INDEX if the entity isn't in the index.
+  [[nodiscard]] uint32_t Get(size_t entity_index) const
+  {
+    const size_t page = entity_index / ENTITY_INDEX_PAGE_SIZE;
+    if (page >= pages_.size() || !pages_[page]) {
+      return INVALID_INDEX;
+    }
+    return (*pages_[page])[entity_index % ENTITY_INDEX_PAGE_SIZE];
+  }
+
+  // Get the packed index of an entity that is known to be in the index. This skips the page checks.
+  [[nodiscard]] uint32_t GetUnchecked(size_t entity_index) const
+  {
+    assert(Contains(entity_index));
+    return (*pages_[entity_index / ENTITY_INDEX_PAGE_SIZE])[entity_index % ENTITY_INDEX_PAGE_SIZE];
+  }
+
+  [[nodiscard]] bool Contains(size_t entity_index) const { return Get(entity_index) != INVALID_INDEX; }
+
+  // Set the packed index of an entity, allocating the page it lives in if needed.
+  void Set(size_t entity_index, uint32_t packed_index)
+  {
+    const size_t page = entity_index / ENTITY_INDEX_PAGE_SIZE;
+    if (page >= pages_.size()) {
+      pages_.resize(page + 1);
+    }
+    if (!pages_[page]) {
+      pages_[page] = std::make_unique<Page>();
+      pages_[page]->fill(INVALID_INDEX);
+    }
+    (*pages_[page])[entity_index % ENTITY_INDEX_PAGE_SIZE] = packed_index;
+  }
+
+  // Remove an entity from the index. Pages are kept around once allocated as it's likely they'll be reused.
+  void Reset(size_t entity_index)
+  {
+    const size_t page = entity_index / ENTITY_INDEX_PAGE_SIZE;
+    if (page < pages_.size() && pages_[page]) {
+      (*pages_[page])[entity_index % ENTITY_INDEX_PAGE_SIZE] = INVALID_INDEX;
+    }
+  }
+
+  // The number of pages that have been allocated.
+  [[nodiscard]] size_t PageCount() const
+  {
+    size_t count = 0;
+    for (const auto& page : pages_) {
+      count += page ? 1 : 0;
+    }
+    return count;
+  }
+
+private:
+  using Page = std::array<uint32_t, ENTITY_INDEX_PAGE_SIZE>;
+  std::vector<std::unique_ptr<Page>> pages_;
+};
+
+#endif// !INCLUDE_ECS_SPARSE_INDEX_HPP_
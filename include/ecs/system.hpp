@@ -1,18 +1,72 @@
 #ifndef INCLUDE_ECS_SYSTEM_HPP_
 #define INCLUDE_ECS_SYSTEM_HPP_
 
+#include "ecs/command_buffer.hpp"
 #include "ecs/component_manager.hpp"
 #include "ecs/entity.hpp"
 #include "ids.hpp"
 #include "ecs/system_signature.hpp"
 #include "ecs/system_manager_interface.hpp"
+#include "ecs/job_system.hpp"
 
-#include "ankerl/unordered_dense.h"
+#include "ecs/entity_set.hpp"
+#include "ecs/resources.hpp"
 
+// The components a system reads and writes in Update(). SystemManager::UpdateSystems() updates systems whose access
+// doesn't conflict at the same time. Systems that haven't declared their access are treated as writing every component
+// in their signatures, and as exclusive if their signatures are empty. Resources are never assumed, a system that uses
+// a resource must declare it.
+struct SystemAccess
+{
+  SystemSignature reads;
+  SystemSignature writes;
+  ResourceMask resource_reads;
+  ResourceMask resource_writes;
+  // An exclusive system never runs alongside another system.
+  bool exclusive{ false };
+
+  template<typename... ComponentNames> SystemAccess& Read()
+  {
+    reads.SetComponent<ComponentNames...>();
+    return *this;
+  }
+
+  template<typename... ComponentNames> SystemAccess& Write()
+  {
+    writes.SetComponent<ComponentNames...>();
+    return *this;
+  }
+
+  template<typename... ResourceNames> SystemAccess& ReadResource()
+  {
+    (SetResource<ResourceNames>(resource_reads), ...);
+    return *this;
+  }
+
+  template<typename... ResourceNames> SystemAccess& WriteResource()
+  {
+    (SetResource<ResourceNames>(resource_writes), ...);
+    return *this;
+  }
 
-using EntitySet = ankerl::unordered_dense::set<Entity>;
+  // Two systems conflict if either writes a component or resource the other reads or writes.
+  [[nodiscard]] bool ConflictsWith(const SystemAccess& other) const
+  {
+    return exclusive || other.exclusive || !(writes & other.writes).Empty() || !(writes & other.reads).Empty()
+           || !(reads & other.writes).Empty() || (resource_writes & (other.resource_writes | other.resource_reads)).any()
+           || (resource_reads & other.resource_writes).any();
+  }
+
+private:
+  template<typename ResourceName> static void SetResource(ResourceMask& mask)
+  {
+    const auto index = resource_index<ResourceName>::value();
+    assert(index < MAX_RESOURCE_COUNT && "Maximum resources exceeded");
+    mask.set(index);
+  }
+};
 
-// A system at the minute is a simple class that tracks a std::unordered_set of
+// A system at the minute is a simple class that tracks an EntitySet of
 // EntityIDs and a SystemSignature that represents the types of components that the
 // system is interested in.
 // It also includes some helper functions to the System.
@@ -28,8 +82,6 @@ public:
   virtual ~System() = default;
   // A handle to the system manager
   ISystemManager* system_manager{ nullptr };
-  // A set of entities that this system is interested in based on the main SystemSignature
-  // ankerl::unordered_dense::set<Entity> entities;
   // The signature of components this system cares about.
   SystemSignature signature;
   // A handle to the component manager
@@ -41,7 +93,7 @@ public:
    * created. This function currently doesn't support adding existing entities to the set only entities made afterward
    *
    * @param signature The system signature of the components this system is interested in.
-   * @return ankerl::unordered_dense::set<Entity>* A handle to the entity set to iterate over.
+   * @return EntitySet* A handle to the entity set to iterate over.
    */
   [[nodiscard]] Result<EntitySet*> RegisterSystemSignature(const SystemSignature& signature);
 
@@ -52,29 +104,111 @@ public:
    */
   void UpdateSystem(const float& delta_time);
 
-  // Get a specific ComponentID vector.
+  // Get the packed components of a specific type.
   // You may want to access entities that don't reflect your system signature.
   // You must not use this function until after the system has been Registered with the system manager.
-  template<typename ComponentName>
-  std::vector<ComponentWrapper<ComponentName>>& GetComponentVector(ComponentID<ComponentName> identifier)
+  template<typename ComponentName> Result<std::span<ComponentName>> GetComponents()
+  {
+    return component_manager->GetComponents<ComponentName>();
+  }
+
+  // Get a View over every entity with all of ComponentNames. This is the fastest way to iterate components as the
+  // component arrays are only resolved once.
+  // You must not use this function until after the system has been Registered with the system manager.
+  template<typename... ComponentNames> Result<View<ComponentNames...>> GetView()
+  {
+    return component_manager->GetView<ComponentNames...>();
+  }
+
+  // The resource of type ResourceName or nullptr if it hasn't been set. Declare the access with
+  // SystemAccess::ReadResource() or WriteResource() so systems that conflict on it don't run together.
+  template<typename ResourceName> [[nodiscard]] ResourceName* GetResource() const
   {
-    return component_manager->GetComponentVector(identifier);
+    return component_manager->GetResources().Get<ResourceName>();
   }
 
+  // The components this system reads and writes in Update().
+  [[nodiscard]] const SystemAccess& GetAccess() const { return access_; }
+
   /**
    * @brief Get the main entities associated to the system signature initially registered.
    *
-   * @return ankerl::unordered_dense::set<Entity>& entity set
+   * @return EntitySet& entity set
    */
-  ankerl::unordered_dense::set<Entity>& GetEntities()
+  EntitySet& GetEntities()
   {
-    assert(!entity_sets.empty());
+    assert(entity_set_count_ > 0);
     return entity_sets[0].second;
   }
 
+  /**
+   * @brief Call func(Entity) for every entity in the main entity set, spread over the ECS job system. The packed
+   * entities are split into chunks of at least min_grain entities. func is called from several threads at once so it
+   * must only write to the components of the entity it's given, to PerThread scratch from GetPerThread() or record
+   * changes through the buffers from CreatePerThreadCommandBuffers().
+   *
+   * @param func The function to call with each entity.
+   * @param min_grain The fewest entities to hand to one thread. Sets this size or smaller run on the calling thread.
+   */
+  template<typename Func> void ParallelEach(Func&& func, size_t min_grain = DEFAULT_PARALLEL_MIN_GRAIN)
+  {
+    const auto& entities = GetEntities();
+    const auto run = [&entities, &func](size_t begin, size_t end) {
+      for (size_t index = begin; index < end; ++index) {
+        func(entities[index]);
+      }
+    };
+    if (job_system_ == nullptr) {
+      run(0, entities.size());
+      return;
+    }
+    job_system_->ParallelForChunks(entities.size(), min_grain, run);
+  }
+
+  // Get a PerThread scratch T for each thread ParallelEach() may run on.
+  template<typename T> [[nodiscard]] PerThread<T> GetPerThread() const { return PerThread<T>{ job_system_ }; }
+
+  // Create a CommandBuffer bound to this system's world for each thread ParallelEach() may run on. Flush them after the
+  // iteration, from one thread.
+  [[nodiscard]] PerThread<CommandBuffer> CreatePerThreadCommandBuffers() const
+  {
+    PerThread<CommandBuffer> command_buffers(job_system_);
+    command_buffers.ForEach([this](CommandBuffer& command_buffer) { command_buffer.SetWorld(world_); });
+    return command_buffers;
+  }
+
+  // The job system used for parallel iteration. Null if the system manager wasn't given one.
+  [[nodiscard]] JobSystem* GetJobSystem() const { return job_system_; }
+
+  /**
+   * @brief Reorder the main entity set to follow the packed order of a component array so iterating the entities
+   * walks that array linearly. Only available in StorageMode::Sparse.
+   *
+   * @return Error An error if the component isn't registered or isn't stored in a ComponentArray.
+   */
+  template<typename ComponentName> Error SortEntitiesByComponent()
+  {
+    auto entities = component_manager->GetComponentEntities<ComponentName>();
+    if (entities.Bad()) {
+      return entities.Error();
+    }
+    GetEntities().RespectOrder(*entities);
+    return Error::OK();
+  }
+
 protected:
+  // Destroy the entity once Update() has finished. Shorthand for Commands().DestroyEntity().
   void MarkEntityForDeletion(const Entity& entity);
 
+  // The tick this system last updated on, 0 before its first update. Filtering a view on Changed<T> or Added<T> since
+  // this tick visits only the components changed since the last update, not counting this system's own changes.
+  [[nodiscard]] uint32_t LastRunTick() const { return last_run_tick_; }
+
+  // Structural changes recorded here are applied once Update() has finished so it's safe to add and remove components
+  // while iterating the system's entities. Systems updated by SystemManager::UpdateSystems() must make every structural
+  // change through here as other systems may be running at the same time.
+  CommandBuffer& Commands() { return commands_; }
+
 private:
   // Let SystemManager access private members to set.
   friend class SystemManager;
@@ -94,7 +228,16 @@ private:
 
 // We don't expose std::vector in the API so just disable the warning here.
 #pragma warning(disable : 4251)
-  ankerl::unordered_dense::set<Entity> entities_to_delete_;
+  CommandBuffer commands_;
+
+  SystemAccess access_;
+  // Whether access_ was declared through SystemManager::SetSystemAccess() rather than derived from the signatures.
+  bool access_declared_{ false };
+
+  // The world of the Entity handles handed out by the entity sets.
+  uint32_t world_{ EntityWorlds::INVALID_WORLD };
+  JobSystem* job_system_{ nullptr };
+  uint32_t last_run_tick_{ 0 };
 
   uint8_t entity_set_count_{ 0 };
 };
@@ -1,14 +1,19 @@
 #ifndef INCLUDE_SYSTEM_MANAGER_H_
 #define INCLUDE_SYSTEM_MANAGER_H_
 
+#include <atomic>
+#include <cstdint>
 #include <memory>
 #include <unordered_map>
 #include <vector>
 
 #include "ecs/component_manager.hpp"
 #include "ecs/entity_manager.hpp"
+#include "ecs/entity_signature_table.hpp"
+#include "ecs/observer.hpp"
 #include "ecs/system.hpp"
 #include "ecs/system_manager_interface.hpp"
+#include "ecs/job_system.hpp"
 #include "ecs/entity.hpp"
 #include "ids.hpp"
 
@@ -21,10 +26,22 @@
 class SystemManager : public ISystemManager
 {
 public:
-  SystemManager(ComponentManager* component_manager, EntityManager* entity_manager) : component_manager_(component_manager), entity_manager_(entity_manager){}
+  // job_system is handed to systems for ParallelEach(). Without one systems iterate on the calling thread.
+  SystemManager(ComponentManager* component_manager, EntityManager* entity_manager, JobSystem* job_system = nullptr)
+    : component_manager_(component_manager), entity_manager_(entity_manager), job_system_(job_system),
+      world_(EntityWorlds::Register({ this, component_manager, entity_manager })),
+      generation_(next_generation_.fetch_add(1, std::memory_order_relaxed))
+  {}
   SystemManager(const SystemManager&) = delete;
   SystemManager& operator=(const SystemManager&) = delete;
-  virtual ~SystemManager() = default;
+  virtual ~SystemManager() { EntityWorlds::Unregister(world_); }
+
+  // The index of the world Entity handles of this system manager route through.
+  [[nodiscard]] uint32_t GetWorldIndex() const { return world_; }
+  // Unique to this system manager for the life of the program, unlike the world index which is reused once it's
+  // destroyed. Never 0.
+  [[nodiscard]] uint64_t GetGeneration() const { return generation_; }
+
   // Register a new system with a required signature.
   template<typename SystemName, typename... Args>
   [[nodiscard]] SystemID<SystemName> RegisterSystem(const SystemSignature& signature, Args... args)
@@ -34,29 +51,148 @@ public:
     system->signature = signature;
     system->component_manager = component_manager_;
     system->system_manager = this;
+    system->world_ = world_;
+    system->job_system_ = job_system_;
+    system->commands_.SetWorld(world_);
     auto res = system->RegisterSystemSignature(signature);
     assert(res);
     return system_id;
   }
 
   // Inform the systems that they no longer need to track this entity
-  // as it's been destroyed
-  void EntityDestroyed(EntityID entity);
+  // as it's been destroyed. Only the entity sets indexed under the entity's components are touched.
+  void EntityDestroyed(EntityID entity) override;
+
+  // Update the entity sets that reference any component that differs between the entity's current signature and
+  // new_entity_signature.
+  void EntitySignatureChanged(EntityID entity_id, const SystemSignature& new_entity_signature) override;
+
+  // Give entities that have no components yet the same signature. The entity sets that want the signature are found
+  // once and the whole batch is inserted into each of them.
+  void EntitiesCreated(std::span<const EntityID> entity_ids, const SystemSignature& signature) override;
+
+  // The same as EntitiesCreated() above with the entity sets already found by FindEntitySets().
+  void EntitiesCreated(std::span<const EntityID> entity_ids,
+    const SystemSignature& signature,
+    std::span<const uint32_t> entity_sets);
+
+  // Find the entity sets that want every entity with signature. The result stays valid until EntitySetCount() changes.
+  void FindEntitySets(const SystemSignature& signature, std::vector<uint32_t>& entity_sets);
+
+  // The number of entity sets registered by every system. Entity sets are never unregistered.
+  [[nodiscard]] size_t EntitySetCount() const { return entity_sets_.size(); }
 
-  void EntitySignatureChanged(EntityID entity_id, const SystemSignature& new_entity_signature);
+  void EntitySetRegistered(System& system, uint8_t entity_set_index) override;
+
+  /**
+   * @brief Register an Observer that records the entities that start or stop matching signature. Like entity sets, only
+   * changes made after registering are recorded.
+   *
+   * @param signature The components to observe. Must not be empty.
+   * @return Result<Observer*> A handle to drain that lives as long as the SystemManager.
+   */
+  [[nodiscard]] Result<Observer*> RegisterObserver(const SystemSignature& signature);
+
+  // Register an Observer of the entities that have all of ComponentNames.
+  template<typename... ComponentNames> [[nodiscard]] Result<Observer*> RegisterObserver()
+  {
+    SystemSignature signature;
+    signature.SetComponent<ComponentNames...>();
+    return RegisterObserver(signature);
+  }
 
   template<typename SystemName> SystemName& GetSystem(SystemID<SystemName> system_id) const
   {
     return *static_cast<SystemName*>(systems_[static_cast<size_t>(system_id.Get())].get());
   }
 
-  [[nodiscard]] SystemSignature& GetEntitySystemSignature(EntityID entity_id) { return signature_map_[entity_id]; }
+  // Declare the components a system reads and writes, replacing the access derived from its signatures.
+  template<typename SystemName> void SetSystemAccess(SystemID<SystemName> system_id, const SystemAccess& access)
+  {
+    auto& system = *systems_[static_cast<size_t>(system_id.Get())];
+    system.access_ = access;
+    system.access_declared_ = true;
+    schedule_dirty_ = true;
+  }
+
+  /**
+   * @brief Update every system in registration order, running systems with non-conflicting access at the same time on
+   * job_system. Systems are grouped into stages where no two systems in a stage conflict and a system is always in a
+   * later stage than any earlier registered system it conflicts with. The command buffers of a stage are flushed in
+   * registration order once every system in the stage has updated.
+   *
+   * @param delta_time The time between previous frame and current.
+   * @param job_system The threads to update the systems on.
+   */
+  void UpdateSystems(const float& delta_time, JobSystem& job_system);
+
+  // The number of stages UpdateSystems() runs the systems in.
+  [[nodiscard]] size_t ScheduleStageCount()
+  {
+    if (schedule_dirty_) {
+      BuildSchedule();
+    }
+    return stages_.size();
+  }
+
+  void EntityComponentAdded(EntityID entity_id, size_t component_id) override;
+  void EntityComponentRemoved(EntityID entity_id, size_t component_id) override;
+
+  [[nodiscard]] SystemSignature GetEntitySystemSignature(EntityID entity_id) const override
+  {
+    return signatures_.GetSignature(entity_id.Index());
+  }
 
 private:
+  // An entity set registered by a system.
+  struct TrackedEntitySet
+  {
+    System* system;
+    uint8_t entity_set_index;
+    // The last signature change this set was tested for. Stops a set being tested once per changed component.
+    uint64_t stamp{ 0 };
+  };
+
+  // Re-test every entity set interested in component_id against the entity's current signature.
+  void UpdateEntitySets(EntityID entity_id, size_t component_id);
+  // Insert or erase an entity from a tracked set based on the entity's signature row.
+  void UpdateEntitySet(uint32_t tracked_index, EntityID entity_id, std::span<const uint64_t> entity_signature);
+
+  // Record the entity in the observers interested in changed_components that it started or stopped matching.
+  void NotifyObservers(EntityID entity_id,
+    const SystemSignature& changed_components,
+    const SystemSignature& old_signature,
+    std::span<const uint64_t> new_signature);
+
+  // Group the systems into stages of non-conflicting systems.
+  void BuildSchedule();
+
   std::vector<std::unique_ptr<System>> systems_;
-  ankerl::unordered_dense::map<EntityID, SystemSignature> signature_map_;
+  // Indices into systems_ of the systems in each stage.
+  std::vector<std::vector<uint32_t>> stages_;
+  bool schedule_dirty_{ true };
+  std::vector<TrackedEntitySet> entity_sets_;
+  // Indexed by component id. The entity sets, as indices into entity_sets_, whose signature contains that component.
+  // Only these sets can change membership when that component is added or removed.
+  std::vector<std::vector<uint32_t>> interest_index_;
+  // Entity sets with an empty signature match every entity so they're tested on every change.
+  std::vector<uint32_t> match_all_sets_;
+  uint64_t change_stamp_{ 0 };
+  // Reused by EntitiesCreated() to avoid reallocating.
+  std::vector<uint32_t> matching_sets_;
+  // Observers are kept behind pointers so their handles stay valid.
+  std::vector<std::unique_ptr<Observer>> observers_;
+  // Indexed by component id. The observers, as indices into observers_, whose signature contains that component.
+  std::vector<std::vector<uint32_t>> observer_interest_;
+  // The component signature of every entity.
+  EntitySignatureTable signatures_;
   ComponentManager* component_manager_;
   EntityManager* entity_manager_;
+  JobSystem* job_system_;
+  // This system manager's slot in EntityWorlds.
+  uint32_t world_;
+  uint64_t generation_;
+  static std::atomic<uint64_t> next_generation_;
 };
 
 #endif
\ No newline at end of file
@@ -1,16 +1,26 @@
 #ifndef INCLUDE_ECS_SYSTEM_MANAGER_INTERFACE_HPP_
 #define INCLUDE_ECS_SYSTEM_MANAGER_INTERFACE_HPP_
 
+#include <span>
+
 #include "ecs/system_signature.hpp"
 #include "ids.hpp"
 
 class Entity;
+class System;
 
 class ISystemManager {
   public:
   virtual void EntityDestroyed(EntityID entity) = 0;
   virtual void EntitySignatureChanged(EntityID entity_id, const SystemSignature& new_entity_signature) = 0;
-  [[nodiscard]] virtual SystemSignature& GetEntitySystemSignature(EntityID entity_id) = 0;
+  // Inform the system manager that entities without any components were all given the same signature.
+  virtual void EntitiesCreated(std::span<const EntityID> entity_ids, const SystemSignature& signature) = 0;
+  // Inform the system manager that a single component was added to or removed from an entity.
+  virtual void EntityComponentAdded(EntityID entity_id, size_t component_id) = 0;
+  virtual void EntityComponentRemoved(EntityID entity_id, size_t component_id) = 0;
+  [[nodiscard]] virtual SystemSignature GetEntitySystemSignature(EntityID entity_id) const = 0;
+  // Called by a System when it registers an entity set so the set can be indexed by the components it references.
+  virtual void EntitySetRegistered(System& system, uint8_t entity_set_index) = 0;
   virtual ~ISystemManager() = default;
 };
 
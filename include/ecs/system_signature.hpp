@@ -1,27 +1,129 @@
 #ifndef INCLUDE_ECS_SYSTEM_SIGNATURE_HPP_
 #define INCLUDE_ECS_SYSTEM_SIGNATURE_HPP_
 
-#include <bitset>
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <span>
 
-#include "ecs/component_manager.hpp"
 #include "ecs/ecs_constants.hpp"
+#include "ecs/type_index.hpp"
 #include "ids.hpp"
 
-// Wrap a bitset but make it easier for users to use the ComponentID etc.
+// A bitset of component ids but make it easier for users to use the ComponentID etc.
+// Bits are stored in 64-bit words so comparisons and iterating the set components work a word at a time, and only the
+// words up to the highest component set are looked at.
 class SystemSignature
 {
 public:
+  static constexpr size_t WORD_COUNT = (MAX_COMPONENT_COUNT + 63) / 64;
+
   SystemSignature() = default;
-  template<typename T> void SetComponent(ComponentID<T> component_id) { bitset_.set(component_id.Get()); }
-  template<typename... Ts> void SetComponent() { (bitset_.set(type_index<Ts>::value()), ...); }
-  template<typename T> void ResetComponent(ComponentID<T> component_id) { bitset_.reset(component_id.Get()); }
-  template<typename... Ts> void ResetComponent() { (bitset_reset(type_index<Ts>::value()), ...); }
-  SystemSignature operator&(const SystemSignature& rhs) const { return SystemSignature{ rhs.bitset_ & bitset_ }; }
-  bool operator==(const SystemSignature& rhs) const { return rhs.bitset_ == bitset_; }
+  // Build a signature from the words of an EntitySignatureTable row.
+  explicit SystemSignature(std::span<const uint64_t> words)
+  {
+    for (size_t word = 0; word < words.size() && word < WORD_COUNT; ++word) {
+      words_[word] = words[word];
+      used_words_ = words[word] != 0 ? word + 1 : used_words_;
+    }
+  }
+  template<typename T> void SetComponent(ComponentID<T> component_id) { Set(component_id.Get()); }
+  template<typename... Ts> void SetComponent() { (Set(type_index<Ts>::value()), ...); }
+  template<typename T> void ResetComponent(ComponentID<T> component_id) { Reset(component_id.Get()); }
+  template<typename... Ts> void ResetComponent() { (Reset(type_index<Ts>::value()), ...); }
+
+  void Set(size_t component_id)
+  {
+    words_[component_id / 64] |= uint64_t{ 1 } << (component_id % 64);
+    used_words_ = std::max(used_words_, component_id / 64 + 1);
+  }
+  void Reset(size_t component_id) { words_[component_id / 64] &= ~(uint64_t{ 1 } << (component_id % 64)); }
+  [[nodiscard]] bool Test(size_t component_id) const
+  {
+    return (words_[component_id / 64] >> (component_id % 64) & 1) != 0;
+  }
+
+  // True if every component in this signature is also in other.
+  [[nodiscard]] bool IsSubsetOf(const SystemSignature& other) const
+  {
+    return IsSubsetOf(std::span<const uint64_t>{ other.words_.data(), other.used_words_ });
+  }
+
+  // True if every component in this signature is set in words, for example an EntitySignatureTable row. Only the
+  // words this signature uses are compared.
+  [[nodiscard]] bool IsSubsetOf(std::span<const uint64_t> words) const
+  {
+    for (size_t word = 0; word < used_words_; ++word) {
+      const uint64_t other = word < words.size() ? words[word] : 0;
+      if ((words_[word] & other) != words_[word]) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  [[nodiscard]] bool Empty() const
+  {
+    for (size_t word = 0; word < used_words_; ++word) {
+      if (words_[word] != 0) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // The number of words up to and including the highest word that has ever had a component set.
+  [[nodiscard]] size_t UsedWordCount() const { return used_words_; }
+
+  // Call func(size_t component_id) for every component in the signature.
+  template<typename Func> void ForEachComponent(Func&& func) const
+  {
+    for (size_t word = 0; word < used_words_; ++word) {
+      uint64_t bits = words_[word];
+      while (bits != 0) {
+        func(word * 64 + static_cast<size_t>(std::countr_zero(bits)));
+        bits &= bits - 1;
+      }
+    }
+  }
+
+  SystemSignature operator&(const SystemSignature& rhs) const
+  {
+    SystemSignature result;
+    result.used_words_ = std::max(used_words_, rhs.used_words_);
+    for (size_t word = 0; word < result.used_words_; ++word) {
+      result.words_[word] = words_[word] & rhs.words_[word];
+    }
+    return result;
+  }
+
+  SystemSignature operator|(const SystemSignature& rhs) const
+  {
+    SystemSignature result;
+    result.used_words_ = std::max(used_words_, rhs.used_words_);
+    for (size_t word = 0; word < result.used_words_; ++word) {
+      result.words_[word] = words_[word] | rhs.words_[word];
+    }
+    return result;
+  }
+
+  SystemSignature operator^(const SystemSignature& rhs) const
+  {
+    SystemSignature result;
+    result.used_words_ = std::max(used_words_, rhs.used_words_);
+    for (size_t word = 0; word < result.used_words_; ++word) {
+      result.words_[word] = words_[word] ^ rhs.words_[word];
+    }
+    return result;
+  }
+
+  bool operator==(const SystemSignature& rhs) const { return rhs.words_ == words_; }
 
 private:
-  explicit SystemSignature(const std::bitset<MAX_COMPONENT_COUNT>& bitset) : bitset_(bitset) {}
-  std::bitset<MAX_COMPONENT_COUNT> bitset_;
+  std::array<uint64_t, WORD_COUNT> words_{};
+  size_t used_words_{ 0 };
 };
 
-#endif // INCLUDE_ECS_SYSTEM_SIGNATURE_HPP_
\ No newline at end of file
+#endif // INCLUDE_ECS_SYSTEM_SIGNATURE_HPP_
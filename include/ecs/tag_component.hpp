@@ -0,0 +1,29 @@
+#ifndef INCLUDE_ECS_TAG_COMPONENT_HPP_
+#define INCLUDE_ECS_TAG_COMPONENT_HPP_
+
+#include <cstddef>
+#include <type_traits>
+
+// Components of an empty type, such as a struct IsEnemy {}, are tags. Only which entities have a tag is stored, there
+// is no value per entity so a tag can't be fetched with GetComponent(). Use HasComponent() instead.
+template<typename T> inline constexpr bool is_tag_component_v = std::is_empty_v<T>;
+
+// The instance handed to iteration callbacks for a tag. Every entity shares it, there is nothing in it to write.
+template<typename T> T& TagInstance()
+{
+  static_assert(is_tag_component_v<T>);
+  static T tag{};
+  return tag;
+}
+
+// Element index of a component array starting at data. For tags data points at TagInstance() and every index is it.
+template<typename T> T& ComponentAt(T* data, size_t index)
+{
+  if constexpr (is_tag_component_v<T>) {
+    return *data;
+  } else {
+    return data[index];
+  }
+}
+
+#endif// !INCLUDE_ECS_TAG_COMPONENT_HPP_
@@ -0,0 +1,30 @@
+#ifndef INCLUDE_ECS_TYPE_INDEX_HPP_
+#define INCLUDE_ECS_TYPE_INDEX_HPP_
+
+#include <atomic>
+#include <cstdint>
+
+namespace internal {
+struct type_index final
+{
+  [[nodiscard]] static uint32_t next() noexcept
+  {
+    // The first use of a type can happen on several job system threads at once.
+    static std::atomic<uint32_t> value{};
+    return value.fetch_add(1, std::memory_order_relaxed);
+  }
+};
+}// namespace internal
+
+// A unique, dense index per type. This is used as the ComponentID of a component type.
+template<typename Type, typename = void> struct type_index final
+{
+  static uint32_t value() noexcept
+  {
+    static const uint32_t value = internal::type_index::next();
+    return value;
+  }
+  constexpr operator uint32_t() const noexcept { return value(); }
+};
+
+#endif// !INCLUDE_ECS_TYPE_INDEX_HPP_
@@ -0,0 +1,206 @@
+#ifndef INCLUDE_ECS_VIEW_HPP_
+#define INCLUDE_ECS_VIEW_HPP_
+
+#include <algorithm>
+#include <cstddef>
+#include <span>
+#include <tuple>
+#include <type_traits>
+
+#include "ecs/archetype_storage.hpp"
+#include "ecs/component_array.hpp"
+#include "ecs/ecs_constants.hpp"
+#include "ecs/job_system.hpp"
+#include "error.hpp"
+#include "ids.hpp"
+
+// Filters for View::Each(since_tick, func). Added<T> keeps the entities whose T was added after since_tick and
+// Changed<T> the entities whose T was added or changed after it.
+template<typename T> struct Added
+{
+  using Component = std::remove_const_t<T>;
+  static std::span<const uint32_t> Ticks(const ComponentArray<Component>& array) { return array.GetAddedTicks(); }
+};
+
+template<typename T> struct Changed
+{
+  using Component = std::remove_const_t<T>;
+  static std::span<const uint32_t> Ticks(const ComponentArray<Component>& array) { return array.GetChangedTicks(); }
+};
+
+// A view over every entity that has all of ComponentNames.
+// The component arrays are resolved once when the view is created so iterating a view doesn't go through the
+// ComponentManager or build a Result per component. In sparse storage the smallest array drives the iteration and the
+// others are looked up through their index. In archetype storage the matching tables are walked directly.
+// Components that aren't named const are marked changed on every entity the view visits, whether or not func writes
+// them, so name components the iteration only reads as const, e.g. View<const Position, Velocity>.
+// A view is cheap to create and shouldn't be kept across component registration.
+template<typename... ComponentNames> class View
+{
+public:
+  static_assert(sizeof...(ComponentNames) > 0, "A view needs at least one component");
+
+  explicit View(ComponentArray<std::remove_const_t<ComponentNames>>*... arrays) : arrays_(arrays...) {}
+  explicit View(ArchetypeStorage* archetypes)
+    : arrays_(static_cast<ComponentArray<std::remove_const_t<ComponentNames>>*>(nullptr)...), archetypes_(archetypes)
+  {}
+
+  /**
+   * @brief Call func(EntityID, ComponentNames&...) for every entity that has all of ComponentNames.
+   * Components must not be added or removed from the viewed arrays while iterating.
+   */
+  template<typename Func> void Each(Func&& func)
+  {
+    if (archetypes_ != nullptr) {
+      archetypes_->Each<std::remove_const_t<ComponentNames>...>(func);
+      return;
+    }
+    const IComponentArray* driver = Driver();
+    EachInRange(driver, DriverEntities(driver), 0, DriverEntities(driver).size(), func);
+  }
+
+  /**
+   * @brief Call func(EntityID, ComponentNames&...) for every entity that has all of ComponentNames and passes Filter,
+   * Added<T> or Changed<T>, since since_tick. Usually since_tick is the calling system's LastRunTick().
+   * The filtered component's array drives the iteration and only its ticks are read to skip entities, so nothing is
+   * hashed or looked up for entities that haven't changed. Archetype storage doesn't track ticks so this returns an
+   * error there without visiting anything.
+   */
+  template<typename Filter, typename Func> Error Each(uint32_t since_tick, Func&& func)
+  {
+    using FilterComponent = typename Filter::Component;
+    if (archetypes_ != nullptr) {
+      return Error{ "Archetype storage doesn't track change ticks" };
+    }
+    auto* array = std::get<ComponentArray<FilterComponent>*>(arrays_);
+    const auto ticks = Filter::Ticks(*array);
+    const auto entities = array->GetEntities();
+    for (size_t index = 0; index < ticks.size(); ++index) {
+      if (IsNewerTick(ticks[index], since_tick)) {
+        Visit(array, index, entities[index], func);
+      }
+    }
+    return Error::OK();
+  }
+
+  /**
+   * @brief Call func(EntityID, ComponentNames&...) for every entity that has all of ComponentNames, spread over the
+   * threads of job_system. The entities are split into chunks of at least min_grain entities. func is called from
+   * several threads at once so it must only write to the components it's given, or to PerThread scratch.
+   * Runs on the calling thread if job_system is null.
+   */
+  template<typename Func>
+  void ParallelEach(JobSystem* job_system, Func&& func, size_t min_grain = DEFAULT_PARALLEL_MIN_GRAIN)
+  {
+    if (job_system == nullptr) {
+      Each(func);
+      return;
+    }
+    if (archetypes_ != nullptr) {
+      archetypes_->ParallelEach<std::remove_const_t<ComponentNames>...>(*job_system, func, min_grain);
+      return;
+    }
+    const IComponentArray* driver = Driver();
+    const auto entities = DriverEntities(driver);
+    job_system->ParallelForChunks(entities.size(), min_grain, [&](size_t begin, size_t end) {
+      EachInRange(driver, entities, begin, end, func);
+    });
+  }
+
+  // An upper bound on the number of entities in the view.
+  [[nodiscard]] size_t SizeHint() const
+  {
+    if (archetypes_ != nullptr) {
+      return std::min({ archetypes_->ComponentCount<std::remove_const_t<ComponentNames>>()... });
+    }
+    return std::apply([](auto*... arrays) { return std::min({ arrays->Size()... }); }, arrays_);
+  }
+
+private:
+  // The array with the fewest components. Iterating it visits the fewest entities that can't be in the view.
+  [[nodiscard]] const IComponentArray* Driver() const
+  {
+    const IComponentArray* driver = nullptr;
+    size_t smallest = 0;
+    std::apply(
+      [&](auto*... arrays) {
+        ((driver == nullptr || arrays->Size() < smallest ? (driver = arrays, smallest = arrays->Size(), 0) : 0), ...);
+      },
+      arrays_);
+    return driver;
+  }
+
+  [[nodiscard]] std::span<const EntityID> DriverEntities(const IComponentArray* driver) const
+  {
+    return std::apply(
+      [driver](auto*... arrays) {
+        std::span<const EntityID> result;
+        ((static_cast<const IComponentArray*>(arrays) == driver ? (result = arrays->GetEntities(), 0) : 0), ...);
+        return result;
+      },
+      arrays_);
+  }
+
+  // Call func for the entities in [begin, end) of the driving array's entities that have every component.
+  template<typename Func>
+  void EachInRange(const IComponentArray* driver,
+    std::span<const EntityID> entities,
+    size_t begin,
+    size_t end,
+    Func& func)
+  {
+    for (size_t index = begin; index < end; ++index) {
+      Visit(driver, index, entities[index], func);
+    }
+  }
+
+  // Call func for the entity at index of the driving array if it has every component, then mark its writable
+  // components changed.
+  template<typename Func> void Visit(const IComponentArray* driver, size_t index, EntityID entity_id, Func& func)
+  {
+    std::apply(
+      [&](auto*... arrays) {
+        std::apply(
+          [&](auto*... components) {
+            if ((components && ...)) {
+              func(entity_id, *components...);
+              (MarkWritten(arrays, components), ...);
+            }
+          },
+          std::make_tuple(Lookup<ComponentNames>(arrays, driver, index, entity_id)...));
+      },
+      arrays_);
+  }
+
+  // The driving array is already positioned at index so only the other arrays need an index lookup. Tags have no
+  // value to fetch so only their membership is checked.
+  template<typename C>
+  static C* Lookup(ComponentArray<std::remove_const_t<C>>* array,
+    const IComponentArray* driver,
+    size_t index,
+    EntityID entity_id)
+  {
+    if constexpr (is_tag_component_v<C>) {
+      const bool member = static_cast<const IComponentArray*>(array) == driver || array->HasComponent(entity_id);
+      return member ? array->Data() : nullptr;
+    } else {
+      if (static_cast<const IComponentArray*>(array) == driver) {
+        return &array->GetComponents()[index];
+      }
+      return array->TryGetComponent(entity_id);
+    }
+  }
+
+  template<typename T> static void MarkWritten(ComponentArray<T>* array, T* component)
+  {
+    if constexpr (!is_tag_component_v<T>) {
+      array->MarkChanged(component);
+    }
+  }
+  template<typename T> static void MarkWritten(ComponentArray<T>* /*array*/, const T* /*component*/) {}
+
+  std::tuple<ComponentArray<std::remove_const_t<ComponentNames>>*...> arrays_;
+  ArchetypeStorage* archetypes_{ nullptr };
+};
+
+#endif// !INCLUDE_ECS_VIEW_HPP_
@@ -0,0 +1,85 @@
+#ifndef INCLUDE_ECS_WORK_STEALING_DEQUE_HPP_
+#define INCLUDE_ECS_WORK_STEALING_DEQUE_HPP_
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "ecs/ecs_constants.hpp"
+
+// A fixed capacity Chase-Lev work stealing deque of pointers.
+// The owning thread pushes and pops at the bottom like a stack, so it works on the most recently pushed (and most
+// likely cached) item. Any other thread can steal from the top, taking the oldest item. Only the owner may call Push()
+// and Pop().
+template<typename T, size_t Capacity = 4096> class WorkStealingDeque
+{
+public:
+  static_assert((Capacity & (Capacity - 1)) == 0, "Capacity must be a power of 2");
+
+  // Push an item to the bottom. Returns false if the deque is full.
+  bool Push(T* item)
+  {
+    const int64_t bottom = bottom_.load(std::memory_order_relaxed);
+    const int64_t top = top_.load(std::memory_order_acquire);
+    if (bottom - top >= static_cast<int64_t>(Capacity)) {
+      return false;
+    }
+    items_[static_cast<size_t>(bottom) & MASK].store(item, std::memory_order_relaxed);
+    bottom_.store(bottom + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Pop the most recently pushed item. Returns nullptr if the deque is empty or a thief took the last item.
+  T* Pop()
+  {
+    const int64_t bottom = bottom_.load(std::memory_order_relaxed) - 1;
+    bottom_.store(bottom, std::memory_order_seq_cst);
+    int64_t top = top_.load(std::memory_order_seq_cst);
+    if (top > bottom) {
+      bottom_.store(bottom + 1, std::memory_order_relaxed);
+      return nullptr;
+    }
+    T* item = items_[static_cast<size_t>(bottom) & MASK].load(std::memory_order_relaxed);
+    if (top == bottom) {
+      // The last item, race any thieves for it.
+      if (!top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+        item = nullptr;
+      }
+      bottom_.store(bottom + 1, std::memory_order_relaxed);
+    }
+    return item;
+  }
+
+  // Steal the oldest item. Returns nullptr if the deque is empty or another thread won the race for the item.
+  T* Steal()
+  {
+    int64_t top = top_.load(std::memory_order_seq_cst);
+    const int64_t bottom = bottom_.load(std::memory_order_seq_cst);
+    if (top >= bottom) {
+      return nullptr;
+    }
+    T* item = items_[static_cast<size_t>(top) & MASK].load(std::memory_order_relaxed);
+    if (!top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+      return nullptr;
+    }
+    return item;
+  }
+
+  // An estimate of the number of items, exact if no other thread is using the deque.
+  [[nodiscard]] size_t SizeEstimate() const
+  {
+    const int64_t size = bottom_.load(std::memory_order_relaxed) - top_.load(std::memory_order_relaxed);
+    return size > 0 ? static_cast<size_t>(size) : 0;
+  }
+
+private:
+  static constexpr size_t MASK = Capacity - 1;
+
+  // top_ and bottom_ are written by different threads so keep them on separate cache lines.
+  alignas(CACHE_LINE_SIZE) std::atomic<int64_t> top_{ 0 };
+  alignas(CACHE_LINE_SIZE) std::atomic<int64_t> bottom_{ 0 };
+  alignas(CACHE_LINE_SIZE) std::array<std::atomic<T*>, Capacity> items_{};
+};
+
+#endif// !INCLUDE_ECS_WORK_STEALING_DEQUE_HPP_
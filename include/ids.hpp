@@ -23,10 +23,39 @@ public:
   T id_;
 };
 
-struct EntityTag
+// A generational entity handle packed into 32 bits. The low INDEX_BITS are the entity's slot, which is what storage is
+// indexed by, and the high VERSION_BITS count how many times the slot has been reused. A handle to a destroyed entity
+// keeps its old version so EntityManager::IsAlive() can tell it apart from a new entity in the same slot. INDEX_BITS is
+// only as wide as MAX_ENTITY_COUNT needs so the version gets every spare bit, and EntityManager retires a slot rather
+// than let its version wrap around.
+class EntityID
 {
+public:
+  static constexpr uint32_t INDEX_BITS = 17;
+  static constexpr uint32_t VERSION_BITS = 32 - INDEX_BITS;
+  static constexpr uint32_t INDEX_MASK = (uint32_t{ 1 } << INDEX_BITS) - 1;
+  static constexpr uint32_t VERSION_MASK = (uint32_t{ 1 } << VERSION_BITS) - 1;
+
+  // Build an id from its packed value, as returned by Get(). A plain index is an id with version 0.
+  constexpr explicit EntityID(size_t identifier) : id_(static_cast<uint32_t>(identifier)) {}
+  [[nodiscard]] static constexpr EntityID FromParts(uint32_t index, uint32_t version)
+  {
+    return EntityID(static_cast<size_t>(((version & VERSION_MASK) << INDEX_BITS) | (index & INDEX_MASK)));
+  }
+
+  constexpr bool operator==(const EntityID& other) const { return id_ == other.id_; }
+
+  constexpr bool operator<(const EntityID& other) const { return id_ < other.id_; }
+
+  // The packed index and version.
+  [[nodiscard]] constexpr uint32_t Get() const { return id_; }
+  // The slot of the entity. Use this to index per entity storage.
+  [[nodiscard]] constexpr uint32_t Index() const { return id_ & INDEX_MASK; }
+  [[nodiscard]] constexpr uint32_t Version() const { return id_ >> INDEX_BITS; }
+
+private:
+  uint32_t id_;
 };
-using EntityID = ID<size_t, EntityTag>;
 
 template<typename ComponentName> using ComponentID = ID<size_t, ComponentName>;
 
@@ -37,6 +66,10 @@ template<typename T, typename Tag> struct hash<ID<T, Tag>>
 {
   T operator()(const ID<T, Tag>& id) const noexcept { return id.Get(); }
 };
+template<> struct hash<EntityID>
+{
+  size_t operator()(const EntityID& id) const noexcept { return id.Get(); }
+};
 }// namespace std
 
 #endif
\ No newline at end of file
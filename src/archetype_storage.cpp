@@ -0,0 +1,103 @@
+#include "ecs/archetype_storage.hpp"
+
+void ArchetypeStorage::EntityDestroyed(EntityID entity_id)
+{
+  if (entity_id.Index() >= records_.size()) {
+    return;
+  }
+  auto& record = records_[entity_id.Index()];
+  if (record.archetype != nullptr) {
+    RemoveRow(record.archetype, record.row);
+    record = {};
+  }
+}
+
+Archetype* ArchetypeStorage::GetOrCreateArchetype(const ComponentMask& mask)
+{
+  auto iter = archetype_lookup_.find(mask);
+  if (iter != archetype_lookup_.end()) {
+    return iter->second;
+  }
+  std::vector<uint32_t> component_ids;
+  size_t row_size = sizeof(EntityID);
+  for (uint32_t id = 0; id < prototypes_.size(); ++id) {
+    if (mask.test(id)) {
+      component_ids.push_back(id);
+      row_size += prototypes_[id]->ElementSize();
+    }
+  }
+  // Size chunks so that a chunk of every column roughly fits in ARCHETYPE_CHUNK_SIZE.
+  const size_t rows_per_chunk = std::max<size_t>(1, ARCHETYPE_CHUNK_SIZE / row_size);
+  std::vector<std::unique_ptr<IArchetypeColumn>> columns;
+  columns.reserve(component_ids.size());
+  for (const auto id : component_ids) {
+    columns.emplace_back(prototypes_[id]->CreateEmpty(rows_per_chunk));
+  }
+  auto& archetype = archetypes_.emplace_back(
+    std::make_unique<Archetype>(mask, std::move(component_ids), std::move(columns), rows_per_chunk));
+  archetype_lookup_.emplace(mask, archetype.get());
+  return archetype.get();
+}
+
+Archetype* ArchetypeStorage::AddTransition(Archetype* from, uint32_t component_id)
+{
+  if (from == nullptr) {
+    ComponentMask mask;
+    mask.set(component_id);
+    return GetOrCreateArchetype(mask);
+  }
+  auto& edge = from->add_edges_[component_id];
+  if (edge == nullptr) {
+    edge = GetOrCreateArchetype(ComponentMask{ from->mask_ }.set(component_id));
+  }
+  return edge;
+}
+
+Archetype* ArchetypeStorage::RemoveTransition(Archetype* from, uint32_t component_id)
+{
+  auto& edge = from->remove_edges_[component_id];
+  if (edge == nullptr) {
+    edge = GetOrCreateArchetype(ComponentMask{ from->mask_ }.reset(component_id));
+  }
+  return edge;
+}
+
+void ArchetypeStorage::MoveEntity(EntityID entity_id, Archetype* destination)
+{
+  auto& record = records_[entity_id.Index()];
+  Archetype* source = record.archetype;
+  const auto new_row = static_cast<uint32_t>(destination->Size());
+  if (source != nullptr) {
+    // Both component id lists are sorted so walk them together to find the shared columns.
+    size_t src = 0;
+    size_t dst = 0;
+    while (src < source->component_ids_.size() && dst < destination->component_ids_.size()) {
+      if (source->component_ids_[src] < destination->component_ids_[dst]) {
+        ++src;
+      } else if (destination->component_ids_[dst] < source->component_ids_[src]) {
+        ++dst;
+      } else {
+        destination->columns_[dst]->PushFrom(*source->columns_[src], record.row);
+        ++src;
+        ++dst;
+      }
+    }
+    RemoveRow(source, record.row);
+  }
+  destination->entities_.push_back(entity_id);
+  record.archetype = destination;
+  record.row = new_row;
+}
+
+void ArchetypeStorage::RemoveRow(Archetype* archetype, uint32_t row)
+{
+  for (auto& column : archetype->columns_) {
+    column->SwapRemove(row);
+  }
+  const auto moved_entity = archetype->entities_.back();
+  archetype->entities_[row] = moved_entity;
+  archetype->entities_.pop_back();
+  if (row < archetype->entities_.size()) {
+    records_[moved_entity.Index()].row = row;
+  }
+}
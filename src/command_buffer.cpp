@@ -0,0 +1,57 @@
+#include "ecs/command_buffer.hpp"
+#include "ecs/entity.hpp"
+
+Error CommandBuffer::Flush()
+{
+  if (command_count_ == 0) {
+    return Error::OK();
+  }
+  const auto& world = World();
+  std::sort(destroyed_.begin(), destroyed_.end());
+  destroyed_.erase(std::unique(destroyed_.begin(), destroyed_.end()), destroyed_.end());
+
+  // Apply the component changes one component array at a time.
+  Error first_error = Error::OK();
+  for (auto& queue : queues_) {
+    if (queue) {
+      auto err = queue->Apply(*world.component_manager, *world.entity_manager, destroyed_, changes_);
+      if (err.Bad() && first_error.Good()) {
+        first_error = err;
+      }
+    }
+  }
+
+  // Group the changes by entity, keeping the recorded order within an entity, so each entity's signature is only
+  // updated once.
+  std::stable_sort(changes_.begin(), changes_.end(), [](const SignatureChange& lhs, const SignatureChange& rhs) {
+    return lhs.entity_id < rhs.entity_id;
+  });
+  for (size_t first = 0; first < changes_.size();) {
+    const EntityID entity_id = changes_[first].entity_id;
+    SystemSignature signature = world.system_manager->GetEntitySystemSignature(entity_id);
+    size_t last = first;
+    for (; last < changes_.size() && changes_[last].entity_id == entity_id; ++last) {
+      if (changes_[last].component_id == NO_COMPONENT) {
+        continue;
+      }
+      if (changes_[last].added) {
+        signature.Set(changes_[last].component_id);
+      } else {
+        signature.Reset(changes_[last].component_id);
+      }
+    }
+    // Created entities that were destroyed in the same flush have nothing to update.
+    if (!std::binary_search(destroyed_.begin(), destroyed_.end(), entity_id)) {
+      world.system_manager->EntitySignatureChanged(entity_id, signature);
+    }
+    first = last;
+  }
+  changes_.clear();
+
+  for (const auto& entity_id : destroyed_) {
+    Entity{ entity_id, world_ }.Destroy();
+  }
+  destroyed_.clear();
+  command_count_ = 0;
+  return first_error;
+}
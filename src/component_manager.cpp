@@ -2,7 +2,26 @@
 
 void ComponentManager::EntityDestroyed(EntityID entity_id)
 {
+  if (storage_mode_ == StorageMode::Archetype) {
+    archetypes_.EntityDestroyed(entity_id);
+    return;
+  }
   for (auto& component : components_) {
-    component->RemoveComponent(entity_id);
+    if (component) {
+      component->RemoveComponent(entity_id);
+    }
+  }
+}
+
+void ComponentManager::EntityDestroyed(EntityID entity_id, const SystemSignature& signature)
+{
+  if (storage_mode_ == StorageMode::Archetype) {
+    archetypes_.EntityDestroyed(entity_id);
+    return;
   }
-}
\ No newline at end of file
+  signature.ForEachComponent([this, entity_id](size_t component_id) {
+    if (component_id < components_.size() && components_[component_id]) {
+      components_[component_id]->RemoveComponent(entity_id);
+    }
+  });
+}
@@ -0,0 +1,29 @@
+#include "ecs/entity.hpp"
+
+#include <exception>
+
+std::array<EntityWorld, MAX_WORLD_COUNT> EntityWorlds::worlds_{};
+std::mutex EntityWorlds::mutex_;
+std::array<bool, MAX_WORLD_COUNT> EntityWorlds::used_{};
+
+uint32_t EntityWorlds::Register(const EntityWorld& world)
+{
+  std::lock_guard lock(mutex_);
+  for (uint32_t world_index = 0; world_index < MAX_WORLD_COUNT; ++world_index) {
+    if (!used_[world_index]) {
+      used_[world_index] = true;
+      worlds_[world_index] = world;
+      return world_index;
+    }
+  }
+  // Every index is taken and handing one out again would route this world's entities through another world.
+  assertm(false, "Too many worlds, raise MAX_WORLD_COUNT");
+  std::terminate();
+}
+
+void EntityWorlds::Unregister(uint32_t world_index)
+{
+  std::lock_guard lock(mutex_);
+  worlds_[world_index] = EntityWorld{};
+  used_[world_index] = false;
+}
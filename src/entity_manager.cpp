@@ -3,22 +3,139 @@
 #include "ids.hpp"
 #include "result.hpp"
 
+namespace {
+constexpr uint64_t TAG_INCREMENT = uint64_t{ 1 } << 32;
+constexpr uint64_t INDEX_MASK = TAG_INCREMENT - 1;
+}// namespace
 
-Result<EntityID> EntityManager::CreateEntity()
+EntityManager::~EntityManager()
 {
-  if (entity_count_ == MAX_ENTITY_COUNT + 1 && free_slots_.empty()) {
-    return "Max entity count reached, cannot create anymore entities";
+  for (auto& page : slot_pages_) {
+    delete page.load();
   }
+}
+
+Result<EntityID> EntityManager::CreateEntity()
+{
   // Check if there are any free entity slots to use first
-  if (!free_slots_.empty()) {
-    auto entity_id = free_slots_.front();
-    free_slots_.pop();
-    return EntityID(entity_id);
+  if (auto entity_id = PopFree()) {
+    live_count_.fetch_add(1, std::memory_order_relaxed);
+    return *entity_id;
+  }
+  // No free slots so take a new id
+  uint64_t entity_id = next_id_.load(std::memory_order_relaxed);
+  do {
+    if (entity_id > static_cast<uint64_t>(MAX_ENTITY_COUNT)) {
+      return "Max entity count reached, cannot create anymore entities";
+    }
+  } while (!next_id_.compare_exchange_weak(entity_id, entity_id + 1, std::memory_order_relaxed));
+  live_count_.fetch_add(1, std::memory_order_relaxed);
+  return EntityID(static_cast<size_t>(entity_id));
+}
+
+Result<std::vector<EntityID>> EntityManager::CreateEntities(size_t count)
+{
+  std::vector<EntityID> entity_ids;
+  entity_ids.reserve(count);
+  while (entity_ids.size() < count) {
+    auto entity_id = PopFree();
+    if (!entity_id) {
+      break;
+    }
+    entity_ids.push_back(*entity_id);
+  }
+  const uint64_t fresh_count = count - entity_ids.size();
+  uint64_t first = next_id_.load(std::memory_order_relaxed);
+  do {
+    if (first + fresh_count > static_cast<uint64_t>(MAX_ENTITY_COUNT) + 1) {
+      // Hand back the reused ids so a failed batch doesn't leak them.
+      for (const auto entity_id : entity_ids) {
+        PushFree(entity_id.Index());
+      }
+      return "Max entity count reached, cannot create anymore entities";
+    }
+  } while (!next_id_.compare_exchange_weak(first, first + fresh_count, std::memory_order_relaxed));
+  for (uint64_t entity_id = first; entity_id < first + fresh_count; ++entity_id) {
+    entity_ids.emplace_back(static_cast<size_t>(entity_id));
+  }
+  live_count_.fetch_add(count, std::memory_order_relaxed);
+  return entity_ids;
+}
+
+void EntityManager::DestroyEntity(EntityID entity_id)
+{
+  const auto index = entity_id.Index();
+  if (index == END_OF_FREE_LIST || index >= next_id_.load(std::memory_order_relaxed)) {
+    return;
+  }
+  auto& slot = GetSlot(index);
+  // Bumping the version is what destroys the entity, so only one of several destroys of the same id goes on.
+  uint32_t version = entity_id.Version();
+  const uint32_t next_version = version + 1;
+  if (version >= EntityID::VERSION_MASK
+      || !slot.version.compare_exchange_strong(version, next_version, std::memory_order_relaxed)) {
+    return;
+  }
+  // A slot whose version has run out is retired instead of reused, a wrapped version would make stale ids alive again.
+  if (next_version != EntityID::VERSION_MASK) {
+    PushFree(index);
   }
-  // No free slots so increment the entity_count
-  return EntityID(entity_count_++);
+  live_count_.fetch_sub(1, std::memory_order_relaxed);
 }
 
-void EntityManager::DestroyEntity(EntityID entity_id) { free_slots_.push(entity_id.Get()); }
+std::optional<EntityID> EntityManager::PopFree()
+{
+  uint64_t head = free_head_.load(std::memory_order_acquire);
+  while ((head & INDEX_MASK) != END_OF_FREE_LIST) {
+    const auto index = static_cast<uint32_t>(head & INDEX_MASK);
+    auto& slot = GetSlot(index);
+    const uint64_t next = slot.next_free.load(std::memory_order_relaxed);
+    if (free_head_.compare_exchange_weak(
+          head, ((head & ~INDEX_MASK) + TAG_INCREMENT) | next, std::memory_order_acq_rel, std::memory_order_acquire)) {
+      return EntityID::FromParts(index, slot.version.load(std::memory_order_relaxed));
+    }
+  }
+  return std::nullopt;
+}
+
+void EntityManager::PushFree(uint32_t index)
+{
+  auto& slot = GetSlot(index);
+  uint64_t head = free_head_.load(std::memory_order_relaxed);
+  do {
+    slot.next_free.store(static_cast<uint32_t>(head & INDEX_MASK), std::memory_order_relaxed);
+  } while (!free_head_.compare_exchange_weak(
+    head, ((head & ~INDEX_MASK) + TAG_INCREMENT) | index, std::memory_order_release, std::memory_order_relaxed));
+}
+
+bool EntityManager::IsAlive(EntityID entity_id) const
+{
+  const auto index = entity_id.Index();
+  // VERSION_MASK marks a retired index, no entity is ever alive with it.
+  return index != END_OF_FREE_LIST && entity_id.Version() != EntityID::VERSION_MASK
+         && index < next_id_.load(std::memory_order_acquire) && GetVersion(index) == entity_id.Version();
+}
+
+uint64_t EntityManager::EntityCount() const { return live_count_.load(std::memory_order_relaxed); }
+
+EntityManager::Slot& EntityManager::GetSlot(uint32_t index)
+{
+  auto& page_slot = slot_pages_[index / ENTITY_INDEX_PAGE_SIZE];
+  SlotPage* page = page_slot.load(std::memory_order_acquire);
+  if (page == nullptr) {
+    // Several threads can race to allocate the page, the first to install theirs wins.
+    auto* new_page = new SlotPage{};
+    if (page_slot.compare_exchange_strong(page, new_page, std::memory_order_acq_rel, std::memory_order_acquire)) {
+      page = new_page;
+    } else {
+      delete new_page;
+    }
+  }
+  return (*page)[index % ENTITY_INDEX_PAGE_SIZE];
+}
 
-uint64_t EntityManager::EntityCount() const { return entity_count_ - 1 - free_slots_.size(); }
\ No newline at end of file
+uint32_t EntityManager::GetVersion(uint32_t index) const
+{
+  const SlotPage* page = slot_pages_[index / ENTITY_INDEX_PAGE_SIZE].load(std::memory_order_acquire);
+  return page != nullptr ? (*page)[index % ENTITY_INDEX_PAGE_SIZE].version.load(std::memory_order_relaxed) : 0;
+}
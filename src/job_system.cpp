@@ -0,0 +1,227 @@
+#include "ecs/job_system.hpp"
+
+thread_local const JobSystem* JobSystem::worker_of_ = nullptr;
+thread_local size_t JobSystem::thread_index_ = JobSystem::NOT_A_JOB_THREAD;
+
+namespace {
+// A cheap per-thread random number for picking which thread to steal from.
+uint32_t NextRandom()
+{
+  thread_local uint32_t state =
+    0x9E3779B9U ^ static_cast<uint32_t>(std::hash<std::thread::id>{}(std::this_thread::get_id()));
+  state ^= state << 13;
+  state ^= state >> 17;
+  state ^= state << 5;
+  return state;
+}
+}// namespace
+
+JobSystem::JobSystem(size_t worker_count) : worker_count_(worker_count), owner_thread_(std::this_thread::get_id())
+{
+  // The creating thread takes slot 0, unless it's already a thread of another job system.
+  if (thread_index_ == NOT_A_JOB_THREAD) {
+    thread_index_ = 0;
+  }
+  deques_.reserve(worker_count_ + 1);
+  for (size_t thread = 0; thread < worker_count_ + 1; ++thread) {
+    deques_.push_back(std::make_unique<JobDeque>());
+  }
+}
+
+JobSystem::~JobSystem()
+{
+  {
+    std::lock_guard lock(sleep_mutex_);
+    stop_.store(true);
+  }
+  wake_.notify_all();
+  for (auto& worker : workers_) {
+    worker.join();
+  }
+  // Jobs that never ran are just freed.
+  for (auto& deque : deques_) {
+    while (Job* job = deque->Steal()) {
+      delete job;
+    }
+  }
+  for (Job* job : shared_jobs_) {
+    delete job;
+  }
+}
+
+void JobSystem::Spawn(std::function<void()> task, JobCounter* counter)
+{
+  if (counter != nullptr) {
+    counter->pending_.fetch_add(1, std::memory_order_relaxed);
+  }
+  Enqueue(new Job{ std::move(task), counter });
+}
+
+void JobSystem::SpawnAfter(JobCounter& dependency, std::function<void()> task, JobCounter* counter)
+{
+  if (counter != nullptr) {
+    counter->pending_.fetch_add(1, std::memory_order_relaxed);
+  }
+  auto* job = new Job{ std::move(task), counter };
+  uint32_t value = dependency.pending_.load(std::memory_order_acquire);
+  while (true) {
+    if (value == 0) {
+      Enqueue(job);
+      return;
+    }
+    if ((value & JobCounter::LOCKED) != 0) {
+      std::this_thread::yield();
+      value = dependency.pending_.load(std::memory_order_acquire);
+      continue;
+    }
+    if (dependency.pending_.compare_exchange_weak(value, value | JobCounter::LOCKED, std::memory_order_acquire)) {
+      break;
+    }
+  }
+  dependency.continuations_.push_back(job);
+  dependency.pending_.fetch_and(~JobCounter::LOCKED, std::memory_order_release);
+}
+
+void JobSystem::WaitHelping(const JobCounter& counter)
+{
+  const bool job_thread = IsJobThread();
+  while (!counter.Done()) {
+    if (!job_thread || !TryRunJob()) {
+      std::this_thread::yield();
+    }
+  }
+}
+
+void JobSystem::StartWorkers()
+{
+  std::call_once(workers_started_, [this] {
+    workers_.reserve(worker_count_);
+    for (size_t worker = 0; worker < worker_count_; ++worker) {
+      workers_.emplace_back([this, worker] { WorkerLoop(worker + 1); });
+    }
+  });
+}
+
+void JobSystem::WorkerLoop(size_t thread_index)
+{
+  worker_of_ = this;
+  thread_index_ = thread_index;
+  constexpr int spins_before_sleeping = 64;
+  int idle_spins = 0;
+  while (!stop_.load(std::memory_order_relaxed)) {
+    if (TryRunJob()) {
+      idle_spins = 0;
+      continue;
+    }
+    if (++idle_spins < spins_before_sleeping) {
+      std::this_thread::yield();
+      continue;
+    }
+    idle_spins = 0;
+    std::unique_lock lock(sleep_mutex_);
+    sleeping_workers_.fetch_add(1);
+    wake_.wait(lock, [this] { return stop_.load() || queued_jobs_.load() > 0; });
+    sleeping_workers_.fetch_sub(1);
+  }
+}
+
+void JobSystem::Enqueue(Job* job)
+{
+  StartWorkers();
+  if (worker_count_ == 0) {
+    RunJob(job);
+    return;
+  }
+  queued_jobs_.fetch_add(1);
+  const bool owner = std::this_thread::get_id() == owner_thread_;
+  if (worker_of_ == this || owner) {
+    if (!deques_[owner ? 0 : thread_index_]->Push(job)) {
+      // The deque is full so just run the job now.
+      queued_jobs_.fetch_sub(1);
+      RunJob(job);
+      return;
+    }
+  } else {
+    std::lock_guard lock(shared_mutex_);
+    shared_jobs_.push_back(job);
+    shared_job_count_.fetch_add(1);
+  }
+  if (sleeping_workers_.load() > 0) {
+    std::lock_guard lock(sleep_mutex_);
+    wake_.notify_one();
+  }
+}
+
+bool JobSystem::TryRunJob()
+{
+  Job* job = FindJob();
+  if (job == nullptr) {
+    return false;
+  }
+  queued_jobs_.fetch_sub(1);
+  RunJob(job);
+  return true;
+}
+
+Job* JobSystem::FindJob()
+{
+  const size_t self = worker_of_ == this ? thread_index_ : 0;
+  if (Job* job = deques_[self]->Pop()) {
+    return job;
+  }
+  if (shared_job_count_.load() > 0) {
+    std::lock_guard lock(shared_mutex_);
+    if (!shared_jobs_.empty()) {
+      Job* job = shared_jobs_.front();
+      shared_jobs_.pop_front();
+      shared_job_count_.fetch_sub(1);
+      return job;
+    }
+  }
+  // Steal from the other threads, starting at a random one so thieves spread out.
+  const size_t start = NextRandom() % deques_.size();
+  for (size_t offset = 0; offset < deques_.size(); ++offset) {
+    const size_t victim = (start + offset) % deques_.size();
+    if (victim == self) {
+      continue;
+    }
+    if (Job* job = deques_[victim]->Steal()) {
+      return job;
+    }
+  }
+  return nullptr;
+}
+
+void JobSystem::RunJob(Job* job)
+{
+  job->task();
+  JobCounter* counter = job->counter;
+  delete job;
+  if (counter == nullptr) {
+    return;
+  }
+  std::vector<Job*> ready;
+  uint32_t value = counter->pending_.load(std::memory_order_acquire);
+  while (true) {
+    if ((value & JobCounter::LOCKED) != 0) {
+      std::this_thread::yield();
+      value = counter->pending_.load(std::memory_order_acquire);
+      continue;
+    }
+    if (value == 1) {
+      // The last job takes the continuations, then unlocks and finishes the counter in one operation.
+      if (counter->pending_.compare_exchange_weak(value, value | JobCounter::LOCKED, std::memory_order_acquire)) {
+        ready.swap(counter->continuations_);
+        counter->pending_.fetch_sub(JobCounter::LOCKED | 1, std::memory_order_acq_rel);
+        break;
+      }
+      continue;
+    }
+    if (counter->pending_.compare_exchange_weak(value, value - 1, std::memory_order_acq_rel)) {
+      break;
+    }
+  }
+  for (Job* continuation : ready) {
+    Enqueue(continuation);
+  }
+}
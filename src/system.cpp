@@ -4,25 +4,31 @@
 
 [[nodiscard]] Result<EntitySet*> System::RegisterSystemSignature(const SystemSignature& signature)
 {
-  if (entity_set_count_ > MAXIMUM_ENTITY_SETS) {
+  if (entity_set_count_ >= MAXIMUM_ENTITY_SETS) {
     return Error{ "Maximum entity set" };
   }
   entity_sets[entity_set_count_].first = signature;
-  return &(entity_sets[entity_set_count_++].second);
+  const auto entity_set_index = entity_set_count_++;
+  auto& entity_set = entity_sets[entity_set_index].second;
+  entity_set.SetWorld(world_);
+  system_manager->EntitySetRegistered(*this, entity_set_index);
+  return &entity_set;
 }
 
 void System::UpdateSystem(const float& delta_time)
 {
+  // Changes made by this update are stamped with run_tick so the next update doesn't see them as new.
+  const uint32_t run_tick = component_manager->AdvanceTick();
+
   // Call user implemented Update() function first
   Update(delta_time);
 
-  // Iterate over entities marked for deletion and delete them.
-  for (auto& entity : entities_to_delete_) {
-    entity.Destroy();
-  }
+  // Apply the structural changes recorded during Update(), including deleting entities marked for deletion.
+  commands_.Flush();
 
-  // Clear deleted entities for next iteration
-  entities_to_delete_.clear();
+  last_run_tick_ = run_tick;
+  // Anything changed after this update is newer than last_run_tick_.
+  component_manager->AdvanceTick();
 }
 
-void System::MarkEntityForDeletion(const Entity& entity) { entities_to_delete_.insert(entity); }
\ No newline at end of file
+void System::MarkEntityForDeletion(const Entity& entity) { commands_.DestroyEntity(entity.GetID()); }
@@ -1,48 +1,294 @@
 #include "ecs/system_manager.hpp"
+
+#include <algorithm>
+
 #include "ecs/entity.hpp"
 #include "ids.hpp"
 
+std::atomic<uint64_t> SystemManager::next_generation_{ 1 };
+
 void SystemManager::EntityDestroyed(EntityID entity_id)
 {
-  // Iterate over all systems an inform them of the entity being removed.
-  for (const auto& system : systems_) {
-    // Destroy from all registered entity sets
-    for (auto& entities : system->entity_sets) {
-      entities.second.erase(Entity{ this, component_manager_, entity_manager_, entity_id });
+  // An entity can only be in the sets whose signature shares a component with it, or that match every entity.
+  ++change_stamp_;
+  const auto erase = [this, entity_id](uint32_t tracked_index) {
+    auto& tracked = entity_sets_[tracked_index];
+    if (tracked.stamp != change_stamp_) {
+      tracked.stamp = change_stamp_;
+      tracked.system->entity_sets[tracked.entity_set_index].second.Erase(entity_id);
+    }
+  };
+  signatures_.GetSignature(entity_id.Index()).ForEachComponent([&](size_t component_id) {
+    if (component_id < interest_index_.size()) {
+      for (const auto tracked_index : interest_index_[component_id]) {
+        erase(tracked_index);
+      }
     }
+  });
+  for (const auto tracked_index : match_all_sets_) {
+    erase(tracked_index);
   }
-  signature_map_[entity_id] = {};
+  if (!observers_.empty()) {
+    const SystemSignature signature = signatures_.GetSignature(entity_id.Index());
+    NotifyObservers(entity_id, signature, signature, {});
+  }
+  signatures_.Clear(entity_id.Index());
 }
 
 void SystemManager::EntitySignatureChanged(EntityID entity_id, const SystemSignature& new_entity_signature)
 {
-  signature_map_[entity_id] = new_entity_signature;
-  for (const auto& system : systems_) {
-    const auto& system_signature = system->signature;
-    // If we AND the system_signature and the new_entity_signature
-    // then we get the minimum set of similar components in a resultant signature.
-    // This can then be compared with the system_signature again and if they are equal
-    // then this system will want to know about this entity.
-    // -------
-    // Example
-    // -------
-    // system_signature     = 00001100
-    // new_entity_signature = 00001111
-    // (system_signature & new_entity_signature) = 00001100
-    // The resultant signature equals the system signature so the system will want to know
-    // about this entity
-    // Legacy support. Deprecate this.
-    // Add to all entity sets.
-    for (auto& entity_pair : system->entity_sets) {
-      const auto& sys_signature = entity_pair.first;
-      auto& entities = entity_pair.second;
-      if ((sys_signature & new_entity_signature) == sys_signature) {
-        entities.emplace(Entity{ this, component_manager_, entity_manager_, entity_id });
-      } else {
-        // It's safe to erase this entity from every system if it doesn't care about it
-        // based on signature. Not the most optimised though.
-        entities.erase(Entity{ this, component_manager_, entity_manager_, entity_id });
+  // Only components that were added or removed can change which entity sets want this entity.
+  const SystemSignature old_signature = signatures_.GetSignature(entity_id.Index());
+  const SystemSignature changed_components = old_signature ^ new_entity_signature;
+  signatures_.Assign(entity_id.Index(), new_entity_signature);
+  const auto row = signatures_.Row(entity_id.Index());
+  ++change_stamp_;
+  changed_components.ForEachComponent([&](size_t component_id) {
+    if (component_id < interest_index_.size()) {
+      for (const auto tracked_index : interest_index_[component_id]) {
+        UpdateEntitySet(tracked_index, entity_id, row);
+      }
+    }
+  });
+  for (const auto tracked_index : match_all_sets_) {
+    UpdateEntitySet(tracked_index, entity_id, row);
+  }
+  if (!observers_.empty()) {
+    NotifyObservers(entity_id, changed_components, old_signature, row);
+  }
+}
+
+void SystemManager::EntitiesCreated(std::span<const EntityID> entity_ids, const SystemSignature& signature)
+{
+  FindEntitySets(signature, matching_sets_);
+  EntitiesCreated(entity_ids, signature, matching_sets_);
+}
+
+void SystemManager::EntitiesCreated(std::span<const EntityID> entity_ids,
+  const SystemSignature& signature,
+  std::span<const uint32_t> entity_sets)
+{
+  for (const auto entity_id : entity_ids) {
+    signatures_.Assign(entity_id.Index(), signature);
+  }
+  for (const auto tracked_index : entity_sets) {
+    const auto& tracked = entity_sets_[tracked_index];
+    auto& entities = tracked.system->entity_sets[tracked.entity_set_index].second;
+    entities.Reserve(entities.size() + entity_ids.size());
+    for (const auto entity_id : entity_ids) {
+      entities.Insert(entity_id);
+    }
+  }
+  if (observers_.empty()) {
+    return;
+  }
+  // New entities had no components so every observer the signature matches sees the whole batch added.
+  ++change_stamp_;
+  signature.ForEachComponent([&](size_t component_id) {
+    if (component_id >= observer_interest_.size()) {
+      return;
+    }
+    for (const auto observer_index : observer_interest_[component_id]) {
+      auto& observer = *observers_[observer_index];
+      if (observer.stamp_ != change_stamp_) {
+        observer.stamp_ = change_stamp_;
+        if (observer.signature_.IsSubsetOf(signature)) {
+          observer.added_.insert(observer.added_.end(), entity_ids.begin(), entity_ids.end());
+        }
+      }
+    }
+  });
+}
+
+void SystemManager::FindEntitySets(const SystemSignature& signature, std::vector<uint32_t>& entity_sets)
+{
+  entity_sets.clear();
+  ++change_stamp_;
+  const auto test = [&](uint32_t tracked_index) {
+    auto& tracked = entity_sets_[tracked_index];
+    if (tracked.stamp == change_stamp_) {
+      return;
+    }
+    tracked.stamp = change_stamp_;
+    if (tracked.system->entity_sets[tracked.entity_set_index].first.IsSubsetOf(signature)) {
+      entity_sets.push_back(tracked_index);
+    }
+  };
+  signature.ForEachComponent([&](size_t component_id) {
+    if (component_id < interest_index_.size()) {
+      for (const auto tracked_index : interest_index_[component_id]) {
+        test(tracked_index);
+      }
+    }
+  });
+  for (const auto tracked_index : match_all_sets_) {
+    test(tracked_index);
+  }
+}
+
+void SystemManager::EntityComponentAdded(EntityID entity_id, size_t component_id)
+{
+  const SystemSignature old_signature = signatures_.GetSignature(entity_id.Index());
+  signatures_.Set(entity_id.Index(), component_id);
+  UpdateEntitySets(entity_id, component_id);
+  if (!observers_.empty()) {
+    SystemSignature changed_components;
+    changed_components.Set(component_id);
+    NotifyObservers(entity_id, changed_components, old_signature, signatures_.Row(entity_id.Index()));
+  }
+}
+
+void SystemManager::EntityComponentRemoved(EntityID entity_id, size_t component_id)
+{
+  const SystemSignature old_signature = signatures_.GetSignature(entity_id.Index());
+  signatures_.Reset(entity_id.Index(), component_id);
+  UpdateEntitySets(entity_id, component_id);
+  if (!observers_.empty()) {
+    SystemSignature changed_components;
+    changed_components.Set(component_id);
+    NotifyObservers(entity_id, changed_components, old_signature, signatures_.Row(entity_id.Index()));
+  }
+}
+
+void SystemManager::UpdateEntitySets(EntityID entity_id, size_t component_id)
+{
+  const auto row = signatures_.Row(entity_id.Index());
+  ++change_stamp_;
+  if (component_id < interest_index_.size()) {
+    for (const auto tracked_index : interest_index_[component_id]) {
+      UpdateEntitySet(tracked_index, entity_id, row);
+    }
+  }
+  for (const auto tracked_index : match_all_sets_) {
+    UpdateEntitySet(tracked_index, entity_id, row);
+  }
+}
+
+void SystemManager::UpdateEntitySet(uint32_t tracked_index,
+  EntityID entity_id,
+  std::span<const uint64_t> entity_signature)
+{
+  auto& tracked = entity_sets_[tracked_index];
+  // A set can be indexed under several changed components, only test it once per change.
+  if (tracked.stamp == change_stamp_) {
+    return;
+  }
+  tracked.stamp = change_stamp_;
+  auto& [set_signature, entities] = tracked.system->entity_sets[tracked.entity_set_index];
+  // If every component in the set signature is in the entity signature then the set wants this entity.
+  // -------
+  // Example
+  // -------
+  // set_signature    = 00001100
+  // entity_signature = 00001111
+  // set_signature is a subset of entity_signature so the set will want to know about this entity
+  if (set_signature.IsSubsetOf(entity_signature)) {
+    entities.Insert(entity_id);
+  } else {
+    entities.Erase(entity_id);
+  }
+}
+
+void SystemManager::NotifyObservers(EntityID entity_id,
+  const SystemSignature& changed_components,
+  const SystemSignature& old_signature,
+  std::span<const uint64_t> new_signature)
+{
+  ++change_stamp_;
+  changed_components.ForEachComponent([&](size_t component_id) {
+    if (component_id >= observer_interest_.size()) {
+      return;
+    }
+    for (const auto observer_index : observer_interest_[component_id]) {
+      auto& observer = *observers_[observer_index];
+      if (observer.stamp_ == change_stamp_) {
+        continue;
       }
+      observer.stamp_ = change_stamp_;
+      const bool matched = observer.signature_.IsSubsetOf(old_signature);
+      const bool matches = observer.signature_.IsSubsetOf(new_signature);
+      if (matches && !matched) {
+        observer.added_.push_back(entity_id);
+      } else if (matched && !matches) {
+        observer.removed_.push_back(entity_id);
+      }
+    }
+  });
+}
+
+Result<Observer*> SystemManager::RegisterObserver(const SystemSignature& signature)
+{
+  if (signature.Empty()) {
+    return Error{ "An observer needs at least one component" };
+  }
+  const auto observer_index = static_cast<uint32_t>(observers_.size());
+  auto* observer = observers_.emplace_back(std::make_unique<Observer>(signature)).get();
+  signature.ForEachComponent([&](size_t component_id) {
+    if (observer_interest_.size() <= component_id) {
+      observer_interest_.resize(component_id + 1);
+    }
+    observer_interest_[component_id].push_back(observer_index);
+  });
+  return observer;
+}
+
+void SystemManager::EntitySetRegistered(System& system, uint8_t entity_set_index)
+{
+  // Without declared access a system is assumed to write every component it tracks.
+  if (!system.access_declared_) {
+    const auto& set_signature = system.entity_sets[entity_set_index].first;
+    system.access_.writes = system.access_.writes | set_signature;
+    system.access_.exclusive = system.access_.exclusive || set_signature.Empty();
+    schedule_dirty_ = true;
+  }
+  const auto tracked_index = static_cast<uint32_t>(entity_sets_.size());
+  entity_sets_.push_back({ &system, entity_set_index });
+  const auto& signature = system.entity_sets[entity_set_index].first;
+  if (signature.Empty()) {
+    match_all_sets_.push_back(tracked_index);
+    return;
+  }
+  signature.ForEachComponent([&](size_t component_id) {
+    if (interest_index_.size() <= component_id) {
+      interest_index_.resize(component_id + 1);
+    }
+    interest_index_[component_id].push_back(tracked_index);
+  });
+}
+
+void SystemManager::UpdateSystems(const float& delta_time, JobSystem& job_system)
+{
+  if (schedule_dirty_) {
+    BuildSchedule();
+  }
+  for (const auto& stage : stages_) {
+    // Systems in a stage don't write anything the others read so they can share a tick, see System::UpdateSystem().
+    const uint32_t run_tick = component_manager_->AdvanceTick();
+    job_system.ParallelFor(stage.size(), [&](size_t index) { systems_[stage[index]]->Update(delta_time); });
+    for (const auto system_index : stage) {
+      systems_[system_index]->commands_.Flush();
+      systems_[system_index]->last_run_tick_ = run_tick;
+    }
+    component_manager_->AdvanceTick();
+  }
+}
+
+void SystemManager::BuildSchedule()
+{
+  stages_.clear();
+  std::vector<uint32_t> system_stages(systems_.size());
+  for (size_t system = 0; system < systems_.size(); ++system) {
+    uint32_t stage = 0;
+    for (size_t earlier = 0; earlier < system; ++earlier) {
+      if (systems_[system]->access_.ConflictsWith(systems_[earlier]->access_)) {
+        stage = std::max(stage, system_stages[earlier] + 1);
+      }
+    }
+    system_stages[system] = stage;
+    if (stages_.size() <= stage) {
+      stages_.resize(stage + 1);
     }
+    stages_[stage].push_back(static_cast<uint32_t>(system));
   }
+  schedule_dirty_ = false;
 }
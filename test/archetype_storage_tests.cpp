@@ -0,0 +1,162 @@
+#include <doctest/doctest.h>
+
+#include "ecs/archetype_storage.hpp"
+#include "ecs/ecs_controller.hpp"
+#include "ids.hpp"
+
+namespace {
+struct Position
+{
+  float x;
+  float y;
+};
+struct Velocity
+{
+  float x;
+  float y;
+};
+struct Health
+{
+  int value;
+};
+}// namespace
+
+TEST_CASE("Test ArchetypeStorage")
+{
+  ArchetypeStorage storage;
+  storage.RegisterComponent<Position>();
+  storage.RegisterComponent<Velocity>();
+  storage.RegisterComponent<Health>();
+
+  EntityID id_0{ 0 };
+  EntityID id_1{ 1 };
+  EntityID id_2{ 2 };
+
+  storage.AddComponent(id_0, Position{ 1, 1 });
+  storage.AddComponent(id_0, Velocity{ 2, 2 });
+  storage.AddComponent(id_1, Position{ 3, 3 });
+  storage.AddComponent(id_1, Velocity{ 4, 4 });
+  storage.AddComponent(id_1, Health{ 5 });
+  storage.AddComponent(id_2, Position{ 6, 6 });
+
+  // Moving rows between tables should keep the values of the components
+  REQUIRE_EQ(storage.GetComponent<Position>(id_0)->x, 1);
+  REQUIRE_EQ(storage.GetComponent<Velocity>(id_0)->x, 2);
+  REQUIRE_EQ(storage.GetComponent<Position>(id_1)->x, 3);
+  REQUIRE_EQ(storage.GetComponent<Health>(id_1)->value, 5);
+  REQUIRE_EQ(storage.GetComponent<Health>(id_0), nullptr);
+  REQUIRE_EQ(storage.ComponentCount<Position>(), 3);
+  REQUIRE_EQ(storage.ComponentCount<Velocity>(), 2);
+
+  size_t count = 0;
+  storage.Each<Position, Velocity>([&](EntityID, Position& position, Velocity& velocity) {
+    position.x += velocity.x;
+    ++count;
+  });
+  REQUIRE_EQ(count, 2);
+  REQUIRE_EQ(storage.GetComponent<Position>(id_0)->x, 3);
+  REQUIRE_EQ(storage.GetComponent<Position>(id_1)->x, 7);
+  REQUIRE_EQ(storage.GetComponent<Position>(id_2)->x, 6);
+
+  // Removing a component moves the entity back to the smaller table
+  storage.RemoveComponent<Health>(id_1);
+  REQUIRE_FALSE(storage.HasComponent<Health>(id_1));
+  REQUIRE_EQ(storage.GetComponent<Velocity>(id_1)->x, 4);
+
+  storage.EntityDestroyed(id_0);
+  REQUIRE_FALSE(storage.HasComponent<Position>(id_0));
+  REQUIRE_EQ(storage.ComponentCount<Position>(), 2);
+  REQUIRE_EQ(storage.GetComponent<Position>(id_1)->x, 7);
+}
+
+TEST_CASE("Test ArchetypeStorage add and remove several components")
+{
+  ArchetypeStorage storage;
+  storage.RegisterComponent<Position>();
+  storage.RegisterComponent<Velocity>();
+  storage.RegisterComponent<Health>();
+
+  const EntityID entity_id{ 1 };
+  const EntityID ids[] = { entity_id };
+  storage.AddComponents(ids, Position{ 1, 1 }, Velocity{ 2, 2 });
+  // Only the final table is created, not one per component added.
+  REQUIRE_EQ(storage.ArchetypeCount(), 1);
+
+  // Existing components are overwritten and new ones added with one move.
+  storage.AddComponents(ids, Position{ 3, 3 }, Health{ 4 });
+  REQUIRE_EQ(storage.ArchetypeCount(), 2);
+  REQUIRE_EQ(storage.GetComponent<Position>(entity_id)->x, 3);
+  REQUIRE_EQ(storage.GetComponent<Velocity>(entity_id)->x, 2);
+  REQUIRE_EQ(storage.GetComponent<Health>(entity_id)->value, 4);
+  REQUIRE_EQ(storage.ComponentCount<Position>(), 1);
+
+  storage.RemoveComponents<Velocity, Health>(entity_id);
+  REQUIRE_EQ(storage.ArchetypeCount(), 3);
+  REQUIRE_FALSE(storage.HasComponent<Velocity>(entity_id));
+  REQUIRE_FALSE(storage.HasComponent<Health>(entity_id));
+  REQUIRE_EQ(storage.GetComponent<Position>(entity_id)->x, 3);
+}
+
+TEST_CASE("Test ArchetypeStorage chunks")
+{
+  ArchetypeStorage storage;
+  storage.RegisterComponent<Position>();
+  storage.RegisterComponent<Health>();
+  // Enough entities to span several chunks
+  constexpr size_t entity_count = ARCHETYPE_CHUNK_SIZE;
+  for (size_t i = 0; i < entity_count; ++i) {
+    storage.AddComponent(EntityID{ i }, Position{ static_cast<float>(i), 0 });
+    storage.AddComponent(EntityID{ i }, Health{ static_cast<int>(i) });
+  }
+  // Remove every other entity's health, moving them between tables
+  for (size_t i = 0; i < entity_count; i += 2) {
+    storage.RemoveComponent<Health>(EntityID{ i });
+  }
+  size_t count = 0;
+  storage.Each<Position, Health>([&](EntityID entity_id, Position& position, Health& health) {
+    REQUIRE_EQ(static_cast<size_t>(position.x), entity_id.Get());
+    REQUIRE_EQ(static_cast<size_t>(health.value), entity_id.Get());
+    ++count;
+  });
+  REQUIRE_EQ(count, entity_count / 2);
+  REQUIRE_EQ(storage.ComponentCount<Position>(), entity_count);
+}
+
+TEST_CASE("Test ECS Controller with archetype storage")
+{
+  struct MovementSystem : public System
+  {
+    void Update(const float& delta_time) override { std::ignore = delta_time; }
+  };
+  ECSController ecs(StorageMode::Archetype);
+  REQUIRE(ecs.RegisterComponent<Position>());
+  REQUIRE(ecs.RegisterComponent<Velocity>());
+  SystemSignature signature;
+  signature.SetComponent<Position, Velocity>();
+  auto system_id = ecs.RegisterSystem<MovementSystem>(signature);
+
+  auto entity_1 = ecs.CreateEntity();
+  REQUIRE(entity_1);
+  REQUIRE(entity_1->AddComponent<Position>({ 1, 2 }));
+  REQUIRE(entity_1->AddComponent<Velocity>({ 3, 4 }));
+  auto entity_2 = ecs.CreateEntity();
+  REQUIRE(entity_2);
+  REQUIRE(entity_2->AddComponent<Position>({ 5, 6 }));
+
+  auto& system = ecs.GetSystem(system_id);
+  REQUIRE_EQ(system.GetEntities().size(), 1);
+  for (const auto& entity : system.GetEntities()) {
+    auto position = entity.GetComponent<Position>();
+    REQUIRE(position.Good());
+    REQUIRE_EQ(position->x, 1);
+  }
+  REQUIRE(entity_2->GetComponent<Velocity>().Bad());
+
+  REQUIRE(entity_1->RemoveComponent<Velocity>());
+  REQUIRE_EQ(system.GetEntities().size(), 0);
+  REQUIRE_EQ(entity_1->GetComponent<Position>()->y, 2);
+
+  entity_1->Destroy();
+  entity_2->Destroy();
+  REQUIRE_EQ(ecs.EntityCount(), 0);
+}
@@ -0,0 +1,231 @@
+#include <doctest/doctest.h>
+
+#include <memory>
+
+#include "ecs/command_buffer.hpp"
+#include "ecs/ecs_controller.hpp"
+#include "ids.hpp"
+
+namespace {
+struct Position
+{
+  float x;
+};
+struct Velocity
+{
+  float x;
+};
+struct Unregistered
+{
+};
+struct Owned
+{
+  std::unique_ptr<int> value;
+};
+
+// Adds a Velocity to every entity with a Position while iterating them, and destroys the entity with the lowest
+// Position.
+struct SpawnVelocitySystem : public System
+{
+  void Update(const float& delta_time) override
+  {
+    std::ignore = delta_time;
+    for (const auto& entity : GetEntities()) {
+      REQUIRE(Commands().AddComponent<Velocity>(entity.GetID(), { 2.0F }));
+      if ((*entity.GetComponent<Position>())->x == 0.0F) {
+        MarkEntityForDeletion(entity);
+      }
+    }
+  }
+};
+// Adds a Velocity to every entity with a Position from several threads at once.
+struct ParallelSpawnSystem : public System
+{
+  void Update(const float& delta_time) override
+  {
+    std::ignore = delta_time;
+    auto command_buffers = CreatePerThreadCommandBuffers();
+    ParallelEach(
+      [&command_buffers](const Entity& entity) {
+        REQUIRE(command_buffers.Local().AddComponent<Velocity>(entity.GetID(), { 3.0F }));
+      },
+      64);
+    command_buffers.ForEach([](CommandBuffer& commands) { commands.Flush(); });
+  }
+};
+struct MovingSystem : public System
+{
+  void Update(const float& delta_time) override { std::ignore = delta_time; }
+};
+}// namespace
+
+TEST_CASE("Test CommandBuffer in a system update")
+{
+  ECSController ecs;
+  REQUIRE(ecs.RegisterComponent<Position>());
+  REQUIRE(ecs.RegisterComponent<Velocity>());
+  SystemSignature spawn_signature;
+  spawn_signature.SetComponent<Position>();
+  auto spawn_id = ecs.RegisterSystem<SpawnVelocitySystem>(spawn_signature);
+  SystemSignature moving_signature;
+  moving_signature.SetComponent<Position, Velocity>();
+  auto moving_id = ecs.RegisterSystem<MovingSystem>(moving_signature);
+
+  for (int index = 0; index < 10; ++index) {
+    auto entity = ecs.CreateEntity();
+    REQUIRE(entity);
+    REQUIRE(entity->AddComponent<Position>({ static_cast<float>(index) }));
+  }
+  REQUIRE_EQ(ecs.GetSystem(spawn_id).GetEntities().size(), 10);
+  REQUIRE_EQ(ecs.GetSystem(moving_id).GetEntities().size(), 0);
+
+  ecs.GetSystem(spawn_id).UpdateSystem(0.0F);
+  REQUIRE_EQ(ecs.EntityCount(), 9);
+  REQUIRE_EQ(ecs.GetSystem(spawn_id).GetEntities().size(), 9);
+  REQUIRE_EQ(ecs.GetSystem(moving_id).GetEntities().size(), 9);
+  for (const auto& entity : ecs.GetSystem(moving_id).GetEntities()) {
+    REQUIRE_EQ((*entity.GetComponent<Velocity>())->x, 2.0F);
+  }
+}
+
+TEST_CASE("Test CommandBuffer flush")
+{
+  ECSController ecs;
+  REQUIRE(ecs.RegisterComponent<Position>());
+  REQUIRE(ecs.RegisterComponent<Velocity>());
+  SystemSignature moving_signature;
+  moving_signature.SetComponent<Position, Velocity>();
+  auto moving_id = ecs.RegisterSystem<MovingSystem>(moving_signature);
+  auto& moving = ecs.GetSystem(moving_id);
+
+  CommandBuffer commands = ecs.CreateCommandBuffer();
+  REQUIRE(commands.Empty());
+  REQUIRE(commands.AddComponent<Unregistered>(EntityID{ 1 }).Bad());
+
+  auto entity_1 = commands.CreateEntity();
+  REQUIRE(entity_1);
+  auto entity_2 = commands.CreateEntity();
+  REQUIRE(entity_2);
+  REQUIRE(commands.AddComponent<Position>(*entity_1, { 1.0F }));
+  REQUIRE(commands.AddComponent<Velocity>(*entity_1, { 1.0F }));
+  REQUIRE(commands.AddComponent<Position>(*entity_2, { 2.0F }));
+  REQUIRE(commands.AddComponent<Velocity>(*entity_2, { 2.0F }));
+  // Commands for the same component are applied in order so entity_2 ends up without a Velocity.
+  REQUIRE(commands.RemoveComponent<Velocity>(*entity_2));
+  REQUIRE_FALSE(commands.Empty());
+  // Nothing changes until the buffer is flushed.
+  REQUIRE_EQ(moving.GetEntities().size(), 0);
+
+  commands.Flush();
+  REQUIRE(commands.Empty());
+  REQUIRE_EQ(moving.GetEntities().size(), 1);
+  REQUIRE(moving.GetEntities().Contains(*entity_1));
+
+  // Component changes to a destroyed entity are dropped.
+  REQUIRE(commands.AddComponent<Velocity>(*entity_2, { 3.0F }));
+  commands.DestroyEntity(*entity_2);
+  commands.DestroyEntity(*entity_1);
+  commands.DestroyEntity(*entity_1);
+  commands.Flush();
+  REQUIRE_EQ(moving.GetEntities().size(), 0);
+  REQUIRE_EQ(ecs.EntityCount(), 0);
+}
+
+TEST_CASE("Test CommandBuffer flush errors")
+{
+  ECSController ecs;
+  REQUIRE(ecs.RegisterComponent<Position>());
+  SystemSignature signature;
+  signature.SetComponent<Position>();
+  auto moving_id = ecs.RegisterSystem<MovingSystem>(signature);
+  auto all_id = ecs.RegisterSystem<MovingSystem>(SystemSignature{});
+
+  // An entity created through the buffer reaches the sets that match every entity even without components.
+  CommandBuffer commands = ecs.CreateCommandBuffer();
+  auto bare = commands.CreateEntity();
+  REQUIRE(bare);
+  REQUIRE(commands.Flush());
+  REQUIRE_EQ(ecs.GetSystem(all_id).GetEntities().size(), 1);
+  REQUIRE_EQ(ecs.GetSystem(moving_id).GetEntities().size(), 0);
+
+  // A command for an entity that's no longer alive is skipped and reported, without touching any signature.
+  auto entity = ecs.CreateEntity();
+  REQUIRE(entity);
+  const auto dead_id = entity->GetID();
+  entity->Destroy();
+  REQUIRE(commands.AddComponent<Position>(dead_id, { 1.0F }));
+  REQUIRE(commands.AddComponent<Position>(*bare, { 2.0F }));
+  REQUIRE(commands.Flush().Bad());
+  REQUIRE_EQ(ecs.GetSystem(moving_id).GetEntities().size(), 1);
+  REQUIRE_EQ(ecs.GetSystem(moving_id).GetEntities()[0].GetID(), *bare);
+  REQUIRE(commands.Empty());
+}
+
+TEST_CASE("Test CommandBuffer per thread")
+{
+  ECSController ecs;
+  REQUIRE(ecs.RegisterComponent<Position>());
+  SystemSignature signature;
+  signature.SetComponent<Position>();
+  auto system_id = ecs.RegisterSystem<MovingSystem>(signature);
+
+  // Reserve entity ids on every thread and attach their components at the sync point.
+  auto command_buffers = ecs.CreatePerThreadCommandBuffers();
+  ecs.GetJobSystem().ParallelFor(1000, [&command_buffers](size_t index) {
+    auto& commands = command_buffers.Local();
+    auto entity_id = commands.CreateEntity();
+    REQUIRE(entity_id);
+    REQUIRE(commands.AddComponent<Position>(*entity_id, { static_cast<float>(index) }));
+  });
+  REQUIRE_EQ(ecs.EntityCount(), 1000);
+  REQUIRE_EQ(ecs.GetSystem(system_id).GetEntities().size(), 0);
+  command_buffers.ForEach([](CommandBuffer& commands) { commands.Flush(); });
+  REQUIRE_EQ(ecs.GetSystem(system_id).GetEntities().size(), 1000);
+}
+
+TEST_CASE("Test CommandBuffer per thread in a system")
+{
+  ECSController ecs;
+  REQUIRE(ecs.RegisterComponent<Position>());
+  REQUIRE(ecs.RegisterComponent<Velocity>());
+  SystemSignature spawn_signature;
+  spawn_signature.SetComponent<Position>();
+  auto spawn_id = ecs.RegisterSystem<ParallelSpawnSystem>(spawn_signature);
+  SystemSignature moving_signature;
+  moving_signature.SetComponent<Position, Velocity>();
+  auto moving_id = ecs.RegisterSystem<MovingSystem>(moving_signature);
+  for (int index = 0; index < 1000; ++index) {
+    auto entity = ecs.CreateEntity();
+    REQUIRE(entity);
+    REQUIRE(entity->AddComponent<Position>({ static_cast<float>(index) }));
+  }
+
+  ecs.GetSystem(spawn_id).UpdateSystem(0.0F);
+  REQUIRE_EQ(ecs.GetSystem(moving_id).GetEntities().size(), 1000);
+  for (const auto& entity : ecs.GetSystem(moving_id).GetEntities()) {
+    REQUIRE_EQ((*entity.GetComponent<Velocity>())->x, 3.0F);
+  }
+}
+
+TEST_CASE("Test CommandBuffer move-only components")
+{
+  ECSController ecs;
+  REQUIRE(ecs.RegisterComponent<Owned>());
+  SystemSignature signature;
+  signature.SetComponent<Owned>();
+  auto system_id = ecs.RegisterSystem<MovingSystem>(signature);
+  CommandBuffer commands = ecs.CreateCommandBuffer();
+  auto entity_id = commands.CreateEntity();
+  REQUIRE(entity_id);
+  REQUIRE(commands.AddComponent(*entity_id, Owned{ std::make_unique<int>(5) }));
+  commands.Flush();
+  const auto& flushed = ecs.GetSystem(system_id).GetEntities();
+  REQUIRE_EQ(flushed.size(), 1);
+  REQUIRE_EQ(flushed[0].GetID(), *entity_id);
+  REQUIRE_EQ(*(*flushed[0].GetComponent<Owned>())->value, 5);
+  auto entity = ecs.CreateEntity();
+  REQUIRE(entity);
+  REQUIRE(entity->EmplaceComponent<Owned>(std::make_unique<int>(6)));
+  REQUIRE_EQ(ecs.EntityCount(), 2);
+  REQUIRE_EQ(*(*entity->GetComponent<Owned>())->value, 6);
+}
@@ -1,5 +1,8 @@
 #include <doctest/doctest.h>
 
+#include <functional>
+#include <memory>
+#include <string>
 #include <vector>
 
 #include "ids.hpp"
@@ -23,8 +26,50 @@ struct TestComponent4
 {
   int a;
 };
+// A move-only component that counts how many live instances own a value.
+struct OwningComponent
+{
+  explicit OwningComponent(int value, int* live) : value(std::make_unique<int>(value)), live(live) { ++*live; }
+  OwningComponent(OwningComponent&& other) noexcept : value(std::move(other.value)), live(other.live) {}
+  OwningComponent& operator=(OwningComponent&& other) noexcept
+  {
+    if (value) {
+      --*live;
+    }
+    value = std::move(other.value);
+    live = other.live;
+    return *this;
+  }
+  ~OwningComponent()
+  {
+    if (value) {
+      --*live;
+    }
+  }
+  std::unique_ptr<int> value;
+  int* live;
+};
 }// namespace
 
+namespace {
+// A component that many entities share identical values of.
+struct Material
+{
+  int shader;
+  int texture;
+  bool operator==(const Material&) const = default;
+};
+}// namespace
+
+template<> struct std::hash<Material>
+{
+  size_t operator()(const Material& material) const noexcept
+  {
+    return std::hash<int>{}(material.shader) * 31 + std::hash<int>{}(material.texture);
+  }
+};
+template<> inline constexpr bool is_shared_component_v<Material> = true;
+
 TEST_CASE("Test ComponentArray")
 {
   ComponentArray<TestComponent1> comp_array(ComponentID<TestComponent1>(0));
@@ -81,6 +126,54 @@ TEST_CASE("Test ComponentArray")
   ValidCheckAndNext(id_5, 5);
 }
 
+TEST_CASE("Test ComponentArray sparse pages")
+{
+  ComponentArray<TestComponent2> comp_array(ComponentID<TestComponent2>(0));
+  EntityID low_id{ 1 };
+  EntityID high_id{ MAX_ENTITY_COUNT };
+  comp_array.AddComponent(low_id, { 1 });
+  comp_array.AddComponent(high_id, { 2 });
+  REQUIRE_EQ(comp_array.Size(), 2);
+  REQUIRE(comp_array.HasComponent(low_id));
+  REQUIRE(comp_array.HasComponent(high_id));
+  // An entity in a page that was never allocated shouldn't have the component
+  REQUIRE_FALSE(comp_array.HasComponent(EntityID{ ENTITY_INDEX_PAGE_SIZE * 2 }));
+  REQUIRE_EQ(comp_array.GetComponent(low_id).a, 1);
+  REQUIRE_EQ(comp_array.GetComponent(high_id).a, 2);
+  // Adding the same component again should overwrite rather than duplicate it
+  comp_array.AddComponent(high_id, { 3 });
+  REQUIRE_EQ(comp_array.Size(), 2);
+  REQUIRE_EQ(comp_array.GetComponent(high_id).a, 3);
+  comp_array.RemoveComponent(low_id);
+  REQUIRE_FALSE(comp_array.HasComponent(low_id));
+  REQUIRE_EQ(comp_array.GetComponent(high_id).a, 3);
+  // Removing twice should be a no-op
+  comp_array.RemoveComponent(low_id);
+  REQUIRE_EQ(comp_array.Size(), 1);
+}
+
+TEST_CASE("Test ComponentArray packed columns")
+{
+  ComponentArray<TestComponent3> comp_array(ComponentID<TestComponent3>(0));
+  for (size_t i = 0; i < 5; ++i) {
+    comp_array.AddComponent(EntityID{ i }, { static_cast<int>(i) });
+  }
+  comp_array.RemoveComponent(EntityID{ 1 });
+  auto components = comp_array.GetComponents();
+  auto entities = comp_array.GetEntities();
+  REQUIRE_EQ(components.size(), 4);
+  REQUIRE_EQ(entities.size(), 4);
+  // Each component should line up with the entity that owns it
+  for (size_t i = 0; i < components.size(); ++i) {
+    REQUIRE_EQ(static_cast<size_t>(components[i].a), entities[i].Get());
+  }
+  // Writing through the span should be visible through GetComponent
+  for (auto& component : components) {
+    component.a += 10;
+  }
+  REQUIRE_EQ(comp_array.GetComponent(EntityID{ 4 }).a, 14);
+}
+
 template<typename T>
 void ValidCheckAndNextFree(ComponentManager& comp_manager, EntityID entity_id, int val){
   auto comp = comp_manager.GetComponent<T>(entity_id);
@@ -179,4 +272,129 @@ TEST_CASE("Test ComponentManager")
   // And the same with entity 4
   comp_manager.RemoveComponent<TestComponent2>(id_4);
   REQUIRE(*comp_manager.GetComponentCount<TestComponent2>() == 0);
-}
\ No newline at end of file
+}
+TEST_CASE("Test ComponentManager entity destroyed with signature")
+{
+  ComponentManager comp_manager;
+  REQUIRE(comp_manager.RegisterComponent<TestComponent1>());
+  REQUIRE(comp_manager.RegisterComponent<TestComponent2>());
+  const EntityID id_0{ 0 };
+  const EntityID id_1{ 1 };
+  REQUIRE(comp_manager.AddComponent<TestComponent1>(id_0, { 1 }));
+  REQUIRE(comp_manager.AddComponent<TestComponent2>(id_0, { 2 }));
+  REQUIRE(comp_manager.AddComponent<TestComponent1>(id_1, { 3 }));
+
+  // Only the arrays in the signature are told about the destruction.
+  SystemSignature signature;
+  signature.SetComponent<TestComponent1>();
+  comp_manager.EntityDestroyed(id_0, signature);
+  REQUIRE(*comp_manager.GetComponentCount<TestComponent1>() == 1);
+  REQUIRE(*comp_manager.GetComponentCount<TestComponent2>() == 1);
+  REQUIRE_FALSE(comp_manager.HasComponent<TestComponent1>(id_0));
+  REQUIRE(comp_manager.HasComponent<TestComponent1>(id_1));
+}
+
+TEST_CASE("Test ComponentManager emplace move-only components")
+{
+  for (const auto storage_mode : { StorageMode::Sparse, StorageMode::Archetype }) {
+    int live = 0;
+    {
+      ComponentManager comp_manager(storage_mode);
+      REQUIRE(comp_manager.RegisterComponent<OwningComponent>());
+      REQUIRE(comp_manager.RegisterComponent<TestComponent1>());
+      for (size_t i = 0; i < 4; ++i) {
+        REQUIRE(comp_manager.EmplaceComponent<OwningComponent>(EntityID{ i }, static_cast<int>(i), &live));
+      }
+      REQUIRE_EQ(live, 4);
+      // Moving to another archetype or swap removing moves the component rather than copying it.
+      REQUIRE(comp_manager.AddComponent(EntityID{ 2 }, TestComponent1{ 7 }));
+      REQUIRE(comp_manager.RemoveComponent<OwningComponent>(EntityID{ 0 }));
+      REQUIRE_EQ(live, 3);
+      REQUIRE_EQ(*(*comp_manager.GetComponent<OwningComponent>(EntityID{ 2 }))->value, 2);
+      REQUIRE_EQ(*(*comp_manager.GetComponent<OwningComponent>(EntityID{ 3 }))->value, 3);
+
+      // Emplacing over an existing component replaces it.
+      REQUIRE(comp_manager.EmplaceComponent<OwningComponent>(EntityID{ 1 }, 10, &live));
+      REQUIRE_EQ(live, 3);
+      REQUIRE_EQ(*(*comp_manager.GetComponent<OwningComponent>(EntityID{ 1 }))->value, 10);
+    }
+    REQUIRE_EQ(live, 0);
+  }
+}
+
+TEST_CASE("Test ComponentManager batch add a stored component")
+{
+  struct Named
+  {
+    std::string name;
+  };
+  for (const auto storage_mode : { StorageMode::Sparse, StorageMode::Archetype }) {
+    ComponentManager comp_manager(storage_mode);
+    REQUIRE(comp_manager.RegisterComponent<Named>());
+    const std::string name(64, 'n');
+    REQUIRE(comp_manager.AddComponent(EntityID{ 0 }, Named{ name }));
+    std::vector<EntityID> batch;
+    for (size_t i = 1; i <= 64; ++i) {
+      batch.emplace_back(i);
+    }
+    // The value lives in the storage the batch grows.
+    REQUIRE(comp_manager.AddComponents<Named>(batch, **comp_manager.GetComponent<Named>(EntityID{ 0 })));
+    for (const auto entity_id : batch) {
+      REQUIRE_EQ((*comp_manager.GetComponent<Named>(entity_id))->name, name);
+    }
+  }
+}
+
+TEST_CASE("Test ComponentManager shared components")
+{
+  ComponentManager comp_manager;
+  REQUIRE(comp_manager.RegisterComponent<Material>());
+  REQUIRE(comp_manager.RegisterComponent<TestComponent1>());
+  for (size_t index = 0; index < 30; ++index) {
+    REQUIRE(comp_manager.AddComponent(EntityID{ index }, Material{ static_cast<int>(index % 3), 7 }));
+  }
+  std::vector<EntityID> batch{ EntityID{ 40 }, EntityID{ 41 }, EntityID{ 42 } };
+  REQUIRE(comp_manager.AddComponents<Material, TestComponent1>(batch, Material{ 0, 7 }, TestComponent1{ 1 }));
+  REQUIRE_EQ(*comp_manager.GetComponentCount<Material>(), 33);
+  REQUIRE(comp_manager.HasComponent<Material>(EntityID{ 41 }));
+
+  // Equal values are stored once and entities with equal values share it.
+  const auto* first = *comp_manager.GetSharedComponent<Material>(EntityID{ 0 });
+  REQUIRE_EQ(first, *comp_manager.GetSharedComponent<Material>(EntityID{ 3 }));
+  REQUIRE_EQ(first, *comp_manager.GetSharedComponent<Material>(EntityID{ 42 }));
+  REQUIRE_NE(first, *comp_manager.GetSharedComponent<Material>(EntityID{ 1 }));
+  REQUIRE_EQ(first->shader, 0);
+  REQUIRE(comp_manager.GetSharedComponent<Material>(EntityID{ 50 }).Bad());
+
+  size_t groups = 0;
+  size_t entities = 0;
+  REQUIRE(comp_manager.EachSharedGroup<Material>([&](const Material& material, std::span<const EntityID> group) {
+    REQUIRE_EQ(group.size(), material.shader == 0 ? 13 : 10);
+    for (const auto entity_id : group) {
+      REQUIRE_EQ(*comp_manager.GetSharedComponent<Material>(entity_id), &material);
+    }
+    ++groups;
+    entities += group.size();
+  }));
+  REQUIRE_EQ(groups, 3);
+  REQUIRE_EQ(entities, 33);
+
+  // A value is released once no entity has it, and giving an entity a new value adds it to the pool.
+  for (size_t index = 1; index < 30; index += 3) {
+    REQUIRE(comp_manager.RemoveComponent<Material>(EntityID{ index }));
+  }
+  REQUIRE(comp_manager.AddComponent(EntityID{ 2 }, Material{ 5, 5 }));
+  comp_manager.EntityDestroyed(EntityID{ 40 });
+  groups = 0;
+  entities = 0;
+  REQUIRE(comp_manager.EachSharedGroup<Material>([&](const Material&, std::span<const EntityID> group) {
+    ++groups;
+    entities += group.size();
+  }));
+  REQUIRE_EQ(groups, 3);
+  REQUIRE_EQ(entities, 22);
+  REQUIRE_EQ((*comp_manager.GetSharedComponent<Material>(EntityID{ 2 }))->shader, 5);
+
+  ComponentManager archetype_manager(StorageMode::Archetype);
+  REQUIRE(archetype_manager.RegisterComponent<Material>().Bad());
+}
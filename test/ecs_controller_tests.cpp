@@ -2,6 +2,20 @@
 
 #include "ecs/ecs_controller.hpp"
 
+namespace {
+struct MeshDescriptor
+{
+  int mesh;
+  bool operator==(const MeshDescriptor&) const = default;
+};
+}// namespace
+
+template<> struct std::hash<MeshDescriptor>
+{
+  size_t operator()(const MeshDescriptor& descriptor) const noexcept { return std::hash<int>{}(descriptor.mesh); }
+};
+template<> inline constexpr bool is_shared_component_v<MeshDescriptor> = true;
+
 TEST_CASE("Test ECS Controller")
 {
   struct TestComponent1
@@ -117,4 +131,451 @@ TEST_CASE("Test ECS Controller")
   REQUIRE_EQ(sys_3.GetEntities().size(), 0);
 
   REQUIRE_EQ(ecs.EntityCount(), 0);
-}
\ No newline at end of file
+}
+TEST_CASE("Test sorting system entities by component")
+{
+  struct SortComponent1
+  {
+    int a;
+  };
+  struct SortComponent2
+  {
+    int a;
+  };
+  struct SortSystem : public System
+  {
+    void Update(const float& delta_time) override { std::ignore = delta_time; }
+  };
+  ECSController ecs;
+  REQUIRE(ecs.RegisterComponent<SortComponent1>());
+  REQUIRE(ecs.RegisterComponent<SortComponent2>());
+  SystemSignature signature;
+  signature.SetComponent<SortComponent1, SortComponent2>();
+  auto system_id = ecs.RegisterSystem<SortSystem>(signature);
+  std::vector<Entity> entities;
+  for (int i = 0; i < 8; ++i) {
+    auto entity = ecs.CreateEntity();
+    REQUIRE(entity);
+    REQUIRE(entity->AddComponent<SortComponent2>({ i }));
+    entities.push_back(*entity);
+  }
+  // Add SortComponent1 in reverse so the entity set order differs from the SortComponent2 array order
+  for (auto iter = entities.rbegin(); iter != entities.rend(); ++iter) {
+    REQUIRE(iter->AddComponent<SortComponent1>({ 0 }));
+  }
+  auto& system = ecs.GetSystem(system_id);
+  REQUIRE(system.SortEntitiesByComponent<SortComponent2>());
+  int expected = 0;
+  for (const auto& entity : system.GetEntities()) {
+    REQUIRE_EQ((*entity.GetComponent<SortComponent2>())->a, expected++);
+  }
+  REQUIRE_EQ(expected, 8);
+}
+
+TEST_CASE("Test system ParallelEach")
+{
+  struct ParallelComponent
+  {
+    int a;
+  };
+  // Doubles every component and counts the entities each thread visited.
+  struct ParallelSystem : public System
+  {
+    void Update(const float& delta_time) override
+    {
+      std::ignore = delta_time;
+      auto counts = GetPerThread<int>();
+      ParallelEach(
+        [&counts](const Entity& entity) {
+          (*entity.GetComponent<ParallelComponent>())->a *= 2;
+          ++counts.Local();
+        },
+        64);
+      counts.ForEach([this](int count) { visited += count; });
+    }
+    int visited{ 0 };
+  };
+  ECSController ecs;
+  REQUIRE(ecs.RegisterComponent<ParallelComponent>());
+  SystemSignature signature;
+  signature.SetComponent<ParallelComponent>();
+  auto system_id = ecs.RegisterSystem<ParallelSystem>(signature);
+  std::vector<Entity> entities;
+  for (int i = 0; i < 3000; ++i) {
+    auto entity = ecs.CreateEntity();
+    REQUIRE(entity);
+    REQUIRE(entity->AddComponent<ParallelComponent>({ i }));
+    entities.push_back(*entity);
+  }
+  auto& system = ecs.GetSystem(system_id);
+  system.UpdateSystem(0.0F);
+  REQUIRE_EQ(system.visited, 3000);
+  for (int i = 0; i < 3000; ++i) {
+    REQUIRE_EQ((*entities[static_cast<size_t>(i)].GetComponent<ParallelComponent>())->a, i * 2);
+  }
+}
+
+TEST_CASE("Test ECS Controller entity handles route to their world")
+{
+  struct Health
+  {
+    int value;
+  };
+  ECSController first;
+  ECSController second;
+  REQUIRE(first.RegisterComponent<Health>());
+  REQUIRE(second.RegisterComponent<Health>());
+  // Both worlds hand out the same id for their first entity, the handles differ by world.
+  auto first_entity = first.CreateEntity();
+  auto second_entity = second.CreateEntity();
+  REQUIRE(first_entity);
+  REQUIRE(second_entity);
+  REQUIRE_EQ(first_entity->GetID(), second_entity->GetID());
+  REQUIRE(*first_entity != *second_entity);
+
+  REQUIRE(first_entity->AddComponent(Health{ 1 }));
+  REQUIRE(second_entity->AddComponent(Health{ 2 }));
+  REQUIRE_EQ((*first_entity->GetComponent<Health>())->value, 1);
+  REQUIRE_EQ((*second_entity->GetComponent<Health>())->value, 2);
+
+  first_entity->Destroy();
+  REQUIRE_FALSE(first_entity->IsAlive());
+  REQUIRE(second_entity->IsAlive());
+  REQUIRE_EQ(second.EntityCount(), 1);
+}
+
+TEST_CASE("Test ECS Controller CreateEntities")
+{
+  struct BatchPosition
+  {
+    int x;
+  };
+  struct BatchVelocity
+  {
+    int dx;
+  };
+  struct BatchSystem : public System
+  {
+    void Update(const float& delta_time) override { std::ignore = delta_time; }
+  };
+  for (const auto storage_mode : { StorageMode::Sparse, StorageMode::Archetype }) {
+    ECSController ecs(storage_mode);
+    REQUIRE(ecs.RegisterComponent<BatchPosition>());
+    REQUIRE(ecs.RegisterComponent<BatchVelocity>());
+    SystemSignature position_signature;
+    position_signature.SetComponent<BatchPosition>();
+    SystemSignature both_signature;
+    both_signature.SetComponent<BatchPosition, BatchVelocity>();
+    auto position_system = ecs.RegisterSystem<BatchSystem>(position_signature);
+    auto both_system = ecs.RegisterSystem<BatchSystem>(both_signature);
+
+    auto positions = ecs.CreateEntities(100, BatchPosition{ 1 });
+    REQUIRE(positions.Good());
+    auto movers = ecs.CreateEntities(50, BatchPosition{ 2 }, BatchVelocity{ 3 });
+    REQUIRE(movers.Good());
+    REQUIRE_EQ(ecs.EntityCount(), 150);
+    REQUIRE_EQ(ecs.GetSystem(position_system).GetEntities().size(), 150);
+    REQUIRE_EQ(ecs.GetSystem(both_system).GetEntities().size(), 50);
+    REQUIRE_EQ((*(*movers)[10].GetComponent<BatchVelocity>())->dx, 3);
+    REQUIRE_EQ((*(*positions)[99].GetComponent<BatchPosition>())->x, 1);
+
+    // Batch entities behave like any other entity afterwards.
+    REQUIRE((*movers)[0].RemoveComponent<BatchVelocity>());
+    REQUIRE_EQ(ecs.GetSystem(both_system).GetEntities().size(), 49);
+    (*positions)[0].Destroy();
+    REQUIRE_EQ(ecs.GetSystem(position_system).GetEntities().size(), 149);
+
+    // Nothing is created if a component isn't registered.
+    struct Unregistered
+    {
+    };
+    REQUIRE(ecs.CreateEntities(10, BatchPosition{ 1 }, Unregistered{}).Bad());
+    REQUIRE_EQ(ecs.EntityCount(), 149);
+  }
+}
+
+TEST_CASE("Test ECS Controller prefabs")
+{
+  struct Enemy
+  {
+    int health;
+    float speed;
+  };
+  struct Weapon
+  {
+    int damage;
+  };
+  struct PrefabSystem : public System
+  {
+    void Update(const float& delta_time) override { std::ignore = delta_time; }
+  };
+  ECSController ecs;
+  REQUIRE(ecs.RegisterComponent<Enemy>());
+  REQUIRE(ecs.RegisterComponent<Weapon>());
+  SystemSignature enemy_signature;
+  enemy_signature.SetComponent<Enemy>();
+  auto enemy_system = ecs.RegisterSystem<PrefabSystem>(enemy_signature);
+
+  Prefab<Enemy, Weapon> grunt(Enemy{ 10, 1.5F }, Weapon{ 2 });
+  auto first_wave = ecs.Instantiate(grunt, 20);
+  REQUIRE(first_wave.Good());
+  REQUIRE_EQ(ecs.GetSystem(enemy_system).GetEntities().size(), 20);
+
+  // A prefab can be changed between instantiations.
+  grunt.Get<Weapon>().damage = 5;
+  auto second_wave = ecs.Instantiate(grunt, 20);
+  REQUIRE(second_wave.Good());
+  REQUIRE_EQ((*(*first_wave)[0].GetComponent<Weapon>())->damage, 2);
+  REQUIRE_EQ((*(*second_wave)[19].GetComponent<Weapon>())->damage, 5);
+  REQUIRE_EQ(ecs.GetSystem(enemy_system).GetEntities().size(), 40);
+
+  // A system registered after the prefab was first used still sees new instances.
+  SystemSignature armed_signature;
+  armed_signature.SetComponent<Enemy, Weapon>();
+  auto armed_system = ecs.RegisterSystem<PrefabSystem>(armed_signature);
+  REQUIRE(ecs.Instantiate(grunt, 5).Good());
+  REQUIRE_EQ(ecs.GetSystem(enemy_system).GetEntities().size(), 45);
+  REQUIRE_EQ(ecs.GetSystem(armed_system).GetEntities().size(), 5);
+
+  // Capture a prefab from an existing entity.
+  auto boss = ecs.CreateEntity();
+  REQUIRE(boss);
+  REQUIRE(boss->AddComponent(Enemy{ 500, 0.5F }));
+  REQUIRE(ecs.CreatePrefab<Enemy, Weapon>(*boss).Bad());
+  auto boss_prefab = ecs.CreatePrefab<Enemy>(*boss);
+  REQUIRE(boss_prefab.Good());
+  auto bosses = ecs.Instantiate(*boss_prefab, 3);
+  REQUIRE(bosses.Good());
+  REQUIRE_EQ((*(*bosses)[2].GetComponent<Enemy>())->health, 500);
+  REQUIRE_EQ(ecs.GetSystem(enemy_system).GetEntities().size(), 49);
+}
+
+TEST_CASE("Test ECS Controller prefabs across worlds")
+{
+  struct Enemy
+  {
+    int health;
+  };
+  struct Shield
+  {
+    int strength;
+  };
+  struct PrefabSystem : public System
+  {
+    void Update(const float& delta_time) override { std::ignore = delta_time; }
+  };
+  Prefab<Enemy> grunt(Enemy{ 10 });
+  uint32_t first_world = 0;
+  {
+    ECSController ecs;
+    REQUIRE(ecs.RegisterComponent<Enemy>());
+    SystemSignature signature;
+    signature.SetComponent<Enemy>();
+    auto system_id = ecs.RegisterSystem<PrefabSystem>(signature);
+    REQUIRE(ecs.Instantiate(grunt, 4).Good());
+    REQUIRE_EQ(ecs.GetSystem(system_id).GetEntities().size(), 4);
+    first_world = (*ecs.CreateEntity()).GetWorldIndex();
+  }
+  // The next world reuses the index and has as many entity sets, but they want a different signature.
+  ECSController ecs;
+  REQUIRE(ecs.RegisterComponent<Enemy>());
+  REQUIRE(ecs.RegisterComponent<Shield>());
+  SystemSignature signature;
+  signature.SetComponent<Enemy, Shield>();
+  auto system_id = ecs.RegisterSystem<PrefabSystem>(signature);
+  auto entities = ecs.Instantiate(grunt, 4);
+  REQUIRE(entities.Good());
+  REQUIRE_EQ((*entities)[0].GetWorldIndex(), first_world);
+  REQUIRE_EQ(ecs.GetSystem(system_id).GetEntities().size(), 0);
+}
+
+TEST_CASE("Test Entity AddComponents and RemoveComponents")
+{
+  struct MultiA
+  {
+    int a;
+  };
+  struct MultiB
+  {
+    int b;
+  };
+  struct MultiC
+  {
+    int c;
+  };
+  struct MultiSystem : public System
+  {
+    void Update(const float& delta_time) override { std::ignore = delta_time; }
+  };
+  for (const auto storage_mode : { StorageMode::Sparse, StorageMode::Archetype }) {
+    ECSController ecs(storage_mode);
+    REQUIRE(ecs.RegisterComponent<MultiA>());
+    REQUIRE(ecs.RegisterComponent<MultiB>());
+    REQUIRE(ecs.RegisterComponent<MultiC>());
+    SystemSignature ab_signature;
+    ab_signature.SetComponent<MultiA, MultiB>();
+    SystemSignature c_signature;
+    c_signature.SetComponent<MultiC>();
+    auto ab_system = ecs.RegisterSystem<MultiSystem>(ab_signature);
+    auto c_system = ecs.RegisterSystem<MultiSystem>(c_signature);
+
+    auto entity = ecs.CreateEntity();
+    REQUIRE(entity);
+    REQUIRE(entity->AddComponents(MultiA{ 1 }, MultiB{ 2 }, MultiC{ 3 }));
+    REQUIRE_EQ(ecs.GetSystem(ab_system).GetEntities().size(), 1);
+    REQUIRE_EQ(ecs.GetSystem(c_system).GetEntities().size(), 1);
+    REQUIRE_EQ((*entity->GetComponent<MultiB>())->b, 2);
+
+    // Values can come straight from another entity's stored components.
+    auto copy = ecs.CreateEntity();
+    REQUIRE(copy);
+    REQUIRE(copy->AddComponents(**entity->GetComponent<MultiA>(), **entity->GetComponent<MultiB>()));
+    REQUIRE_EQ((*copy->GetComponent<MultiA>())->a, 1);
+    REQUIRE_EQ(ecs.GetSystem(ab_system).GetEntities().size(), 2);
+    copy->Destroy();
+
+    REQUIRE(entity->RemoveComponents<MultiA, MultiC>());
+    REQUIRE_EQ(ecs.GetSystem(ab_system).GetEntities().size(), 0);
+    REQUIRE_EQ(ecs.GetSystem(c_system).GetEntities().size(), 0);
+    REQUIRE(entity->GetComponent<MultiA>().Bad());
+    REQUIRE_EQ((*entity->GetComponent<MultiB>())->b, 2);
+
+    // Nothing changes if one of the components isn't registered.
+    struct Unregistered
+    {
+    };
+    REQUIRE(entity->AddComponents(MultiA{ 1 }, Unregistered{}).Bad());
+    REQUIRE(entity->GetComponent<MultiA>().Bad());
+  }
+}
+
+TEST_CASE("Test ECS Controller observers")
+{
+  struct Observed
+  {
+    int a;
+  };
+  struct Other
+  {
+    int b;
+  };
+  for (const auto storage_mode : { StorageMode::Sparse, StorageMode::Archetype }) {
+    ECSController ecs(storage_mode);
+    REQUIRE(ecs.RegisterComponent<Observed>());
+    REQUIRE(ecs.RegisterComponent<Other>());
+    auto observed = ecs.RegisterObserver<Observed>();
+    REQUIRE(observed);
+    auto both = ecs.RegisterObserver<Observed, Other>();
+    REQUIRE(both);
+    REQUIRE(ecs.RegisterObserver(SystemSignature{}).Bad());
+
+    auto entity_1 = ecs.CreateEntity();
+    REQUIRE(entity_1);
+    auto entity_2 = ecs.CreateEntity();
+    REQUIRE(entity_2);
+    REQUIRE(entity_1->AddComponent(Observed{ 1 }));
+    REQUIRE(entity_2->AddComponents(Observed{ 2 }, Other{ 2 }));
+    // Replacing a component doesn't change which observers match.
+    REQUIRE(entity_1->AddComponent(Observed{ 3 }));
+    REQUIRE_EQ((*observed)->Added().size(), 2);
+    REQUIRE_EQ((*observed)->Added()[0], entity_1->GetID());
+    REQUIRE_EQ((*observed)->Added()[1], entity_2->GetID());
+    REQUIRE_EQ((*both)->Added().size(), 1);
+    REQUIRE_EQ((*both)->Added()[0], entity_2->GetID());
+    (*observed)->Clear();
+    (*both)->Clear();
+    REQUIRE((*observed)->Empty());
+
+    // Losing one component of the signature or being destroyed removes an entity.
+    REQUIRE(entity_2->RemoveComponent<Other>());
+    REQUIRE((*observed)->Empty());
+    REQUIRE_EQ((*both)->Removed().size(), 1);
+    const auto entity_1_id = entity_1->GetID();
+    entity_1->Destroy();
+    REQUIRE_EQ((*observed)->Removed().size(), 1);
+    REQUIRE_EQ((*observed)->Removed()[0], entity_1_id);
+
+    // A batch of new entities is recorded at once.
+    auto created = ecs.CreateEntities(5, Observed{ 0 }, Other{ 0 });
+    REQUIRE(created);
+    REQUIRE_EQ((*observed)->Added().size(), 5);
+    REQUIRE_EQ((*both)->Added().size(), 5);
+  }
+}
+
+TEST_CASE("Test ECS Controller resources")
+{
+  struct FrameClock
+  {
+    float elapsed;
+    int frame;
+  };
+  struct PhysicsConfig
+  {
+    float gravity;
+  };
+  struct StepSystem : public System
+  {
+    void Update(const float& delta_time) override
+    {
+      auto* clock = GetResource<FrameClock>();
+      REQUIRE(clock != nullptr);
+      clock->elapsed += delta_time;
+      ++clock->frame;
+    }
+  };
+  struct GravitySystem : public System
+  {
+    float seen_gravity{ 0.0F };
+    void Update(const float& /*delta_time*/) override { seen_gravity = GetResource<PhysicsConfig>()->gravity; }
+  };
+
+  ECSController ecs;
+  REQUIRE(ecs.GetResource<FrameClock>() == nullptr);
+  ecs.SetResource<FrameClock>(0.0F, 0);
+  auto& config = ecs.SetResource<PhysicsConfig>(-9.8F);
+  REQUIRE_EQ(ecs.GetResource<PhysicsConfig>(), &config);
+
+  auto step = ecs.RegisterSystem<StepSystem>(SystemSignature{});
+  auto gravity = ecs.RegisterSystem<GravitySystem>(SystemSignature{});
+  ecs.SetSystemAccess(step, SystemAccess{}.WriteResource<FrameClock>());
+  ecs.SetSystemAccess(gravity, SystemAccess{}.ReadResource<PhysicsConfig>());
+  ecs.UpdateSystems(0.5F);
+  ecs.UpdateSystems(0.5F);
+  REQUIRE_EQ(ecs.GetResource<FrameClock>()->frame, 2);
+  REQUIRE_EQ(ecs.GetResource<FrameClock>()->elapsed, doctest::Approx(1.0F));
+  REQUIRE_EQ(ecs.GetSystem(gravity).seen_gravity, doctest::Approx(-9.8F));
+
+  // Setting a resource again replaces it.
+  ecs.SetResource<FrameClock>(0.0F, 10);
+  REQUIRE_EQ(ecs.GetResource<FrameClock>()->frame, 10);
+  ecs.RemoveResource<FrameClock>();
+  REQUIRE(ecs.GetResource<FrameClock>() == nullptr);
+}
+
+TEST_CASE("Test ECS Controller shared components")
+{
+  struct MeshSystem : public System
+  {
+    void Update(const float& delta_time) override { std::ignore = delta_time; }
+  };
+  ECSController ecs;
+  REQUIRE(ecs.RegisterComponent<MeshDescriptor>());
+  SystemSignature signature;
+  signature.SetComponent<MeshDescriptor>();
+  auto system = ecs.RegisterSystem<MeshSystem>(signature);
+
+  auto entity = ecs.CreateEntity();
+  REQUIRE(entity);
+  REQUIRE(entity->AddComponent(MeshDescriptor{ 3 }));
+  REQUIRE_EQ((*entity->GetSharedComponent<MeshDescriptor>())->mesh, 3);
+  auto prefab = ecs.CreatePrefab<MeshDescriptor>(*entity);
+  REQUIRE(prefab);
+  REQUIRE(ecs.Instantiate(*prefab, 10));
+  REQUIRE_EQ(ecs.GetSystem(system).GetEntities().size(), 11);
+  for (const auto& instance : ecs.GetSystem(system).GetEntities()) {
+    REQUIRE_EQ(*instance.GetSharedComponent<MeshDescriptor>(), *entity->GetSharedComponent<MeshDescriptor>());
+  }
+  REQUIRE(entity->RemoveComponent<MeshDescriptor>());
+  REQUIRE_EQ(ecs.GetSystem(system).GetEntities().size(), 10);
+}
@@ -1,5 +1,9 @@
 #include <doctest/doctest.h>
 
+#include <set>
+#include <thread>
+#include <vector>
+
 #include "ecs/entity_manager.hpp"
 #include "ecs/ecs_constants.hpp"
 #include "ids.hpp"
@@ -36,3 +40,113 @@ TEST_CASE("Test entity manager limits")
   result = entity_manager.CreateEntity();
   REQUIRE(result.Good());
 }
+
+TEST_CASE("Test entity manager stale ids")
+{
+  EntityManager entity_manager;
+  auto first = entity_manager.CreateEntity();
+  REQUIRE(first.Good());
+  REQUIRE(entity_manager.IsAlive(*first));
+  entity_manager.DestroyEntity(*first);
+  REQUIRE_FALSE(entity_manager.IsAlive(*first));
+
+  // The index is reused with a new version so the old id stays dead.
+  auto second = entity_manager.CreateEntity();
+  REQUIRE(second.Good());
+  REQUIRE_EQ((*second).Index(), (*first).Index());
+  REQUIRE_NE((*second).Version(), (*first).Version());
+  REQUIRE_FALSE(entity_manager.IsAlive(*first));
+  REQUIRE(entity_manager.IsAlive(*second));
+
+  // Destroying the stale id again leaves the new entity alone.
+  entity_manager.DestroyEntity(*first);
+  REQUIRE(entity_manager.IsAlive(*second));
+  REQUIRE_EQ(entity_manager.EntityCount(), 1);
+  REQUIRE_FALSE(entity_manager.IsAlive(EntityID{ 12345 }));
+}
+
+TEST_CASE("Test entity manager retires saturated indices")
+{
+  EntityManager entity_manager;
+  auto entity_id = entity_manager.CreateEntity();
+  REQUIRE(entity_id.Good());
+  const auto first = *entity_id;
+  // Churn one index until its version runs out, the index is reused every time until then.
+  for (uint32_t version = 0; version + 1 < EntityID::VERSION_MASK; ++version) {
+    entity_manager.DestroyEntity(*entity_id);
+    entity_id = entity_manager.CreateEntity();
+    REQUIRE(entity_id.Good());
+    REQUIRE_EQ((*entity_id).Index(), first.Index());
+  }
+  REQUIRE_EQ((*entity_id).Version(), EntityID::VERSION_MASK - 1);
+  entity_manager.DestroyEntity(*entity_id);
+
+  // The saturated index is retired instead of wrapping back to the version of first.
+  auto fresh = entity_manager.CreateEntity();
+  REQUIRE(fresh.Good());
+  REQUIRE_NE((*fresh).Index(), first.Index());
+  REQUIRE_FALSE(entity_manager.IsAlive(first));
+  REQUIRE_FALSE(entity_manager.IsAlive(EntityID::FromParts(first.Index(), EntityID::VERSION_MASK)));
+  // Destroying the retired id does nothing either.
+  entity_manager.DestroyEntity(EntityID::FromParts(first.Index(), EntityID::VERSION_MASK));
+  REQUIRE_EQ(entity_manager.EntityCount(), 1);
+}
+
+TEST_CASE("Test entity manager create entities")
+{
+  EntityManager entity_manager;
+  auto first = entity_manager.CreateEntities(10);
+  REQUIRE(first.Good());
+  REQUIRE_EQ(first->size(), 10);
+  entity_manager.DestroyEntity((*first)[3]);
+  entity_manager.DestroyEntity((*first)[7]);
+
+  // The destroyed ids are reused before new ones are taken.
+  auto second = entity_manager.CreateEntities(5);
+  REQUIRE(second.Good());
+  REQUIRE_EQ(entity_manager.EntityCount(), 13);
+  std::set<uint32_t> reused{ (*second)[0].Index(), (*second)[1].Index() };
+  REQUIRE_EQ(reused, std::set<uint32_t>{ (*first)[3].Index(), (*first)[7].Index() });
+  for (const auto entity_id : *second) {
+    REQUIRE(entity_manager.IsAlive(entity_id));
+  }
+
+  // A batch that doesn't fit creates nothing.
+  REQUIRE(entity_manager.CreateEntities(MAX_ENTITY_COUNT).Bad());
+  REQUIRE_EQ(entity_manager.EntityCount(), 13);
+}
+
+TEST_CASE("Test entity manager concurrent create and destroy")
+{
+  EntityManager entity_manager;
+  constexpr size_t thread_count = 4;
+  constexpr size_t per_thread = 5000;
+  std::vector<std::vector<EntityID>> created(thread_count);
+  std::vector<std::thread> threads;
+  for (size_t thread = 0; thread < thread_count; ++thread) {
+    threads.emplace_back([&entity_manager, &ids = created[thread]] {
+      // Destroy every other id straight away so the free list is pushed and popped from every thread.
+      for (size_t i = 0; i < per_thread; ++i) {
+        auto entity_id = entity_manager.CreateEntity();
+        REQUIRE(entity_id.Good());
+        if (i % 2 == 0) {
+          entity_manager.DestroyEntity(*entity_id);
+        } else {
+          ids.push_back(*entity_id);
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  REQUIRE_EQ(entity_manager.EntityCount(), thread_count * per_thread / 2);
+  // Every live id is unique.
+  std::set<size_t> unique_ids;
+  for (const auto& ids : created) {
+    for (const auto& entity_id : ids) {
+      REQUIRE(unique_ids.insert(entity_id.Get()).second);
+    }
+  }
+  REQUIRE_EQ(unique_ids.size(), thread_count * per_thread / 2);
+}
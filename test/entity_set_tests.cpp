@@ -0,0 +1,85 @@
+#include <doctest/doctest.h>
+
+#include <vector>
+
+#include "ecs/entity_set.hpp"
+#include "ids.hpp"
+
+TEST_CASE("Test EntitySet")
+{
+  EntitySet entity_set;
+  REQUIRE(entity_set.empty());
+  REQUIRE(entity_set.Insert(EntityID{ 1 }));
+  REQUIRE(entity_set.Insert(EntityID{ 5000 }));
+  REQUIRE(entity_set.Insert(EntityID{ 3 }));
+  REQUIRE_FALSE(entity_set.Insert(EntityID{ 3 }));
+  REQUIRE_EQ(entity_set.size(), 3);
+  REQUIRE(entity_set.Contains(EntityID{ 5000 }));
+  REQUIRE_FALSE(entity_set.Contains(EntityID{ 2 }));
+  // An id with the same index but an older version is a different entity.
+  REQUIRE_FALSE(entity_set.Contains(EntityID::FromParts(5000, 1)));
+  REQUIRE_FALSE(entity_set.Erase(EntityID::FromParts(5000, 1)));
+
+  REQUIRE(entity_set.Erase(EntityID{ 1 }));
+  REQUIRE_FALSE(entity_set.Erase(EntityID{ 1 }));
+  REQUIRE_EQ(entity_set.size(), 2);
+  REQUIRE_FALSE(entity_set.Contains(EntityID{ 1 }));
+
+  std::vector<size_t> ids;
+  for (const auto& entity : entity_set) {
+    ids.push_back(entity.GetID().Get());
+  }
+  REQUIRE_EQ(ids.size(), 2);
+  REQUIRE(entity_set.Contains(EntityID{ ids[0] }));
+  REQUIRE(entity_set.Contains(EntityID{ ids[1] }));
+
+  entity_set.Clear();
+  REQUIRE(entity_set.empty());
+  REQUIRE_FALSE(entity_set.Contains(EntityID{ 5000 }));
+}
+
+TEST_CASE("Test EntitySet RespectOrder")
+{
+  EntitySet entity_set;
+  for (size_t i = 0; i < 6; ++i) {
+    entity_set.Insert(EntityID{ i });
+  }
+  // Order contains an entity that isn't in the set and misses some that are
+  std::vector<EntityID> order{ EntityID{ 4 }, EntityID{ 10 }, EntityID{ 2 }, EntityID{ 0 } };
+  entity_set.RespectOrder(order);
+  auto ids = entity_set.GetIDs();
+  REQUIRE_EQ(ids.size(), 6);
+  REQUIRE_EQ(ids[0], 4);
+  REQUIRE_EQ(ids[1], 2);
+  REQUIRE_EQ(ids[2], 0);
+  // The rest keep their relative order.
+  REQUIRE_EQ(ids[3], 1);
+  REQUIRE_EQ(ids[4], 3);
+  REQUIRE_EQ(ids[5], 5);
+  for (size_t i = 0; i < ids.size(); ++i) {
+    REQUIRE(entity_set.Contains(EntityID{ ids[i] }));
+  }
+  // The set should still erase correctly after reordering
+  REQUIRE(entity_set.Erase(EntityID{ 2 }));
+  REQUIRE(entity_set.Erase(EntityID{ 5 }));
+  REQUIRE_EQ(entity_set.size(), 4);
+  REQUIRE(entity_set.Contains(EntityID{ 4 }));
+  REQUIRE(entity_set.Contains(EntityID{ 1 }));
+}
+
+TEST_CASE("Test EntitySet RespectOrder ignores stale ids")
+{
+  EntitySet entity_set;
+  const auto live = EntityID::FromParts(3, 1);
+  entity_set.Insert(EntityID{ 1 });
+  entity_set.Insert(live);
+  // An older id for the same index must not overwrite the live one.
+  std::vector<EntityID> order{ EntityID::FromParts(3, 0), EntityID{ 1 } };
+  entity_set.RespectOrder(order);
+  auto ids = entity_set.GetIDs();
+  REQUIRE_EQ(ids.size(), 2);
+  REQUIRE_EQ(ids[0], 1);
+  REQUIRE_EQ(ids[1], live.Get());
+  REQUIRE(entity_set.Contains(live));
+  REQUIRE_FALSE(entity_set.Contains(EntityID::FromParts(3, 0)));
+}
@@ -0,0 +1,146 @@
+#include <doctest/doctest.h>
+
+#include "ecs/component_manager.hpp"
+#include "ecs/group.hpp"
+#include "ecs/view.hpp"
+#include "ids.hpp"
+
+namespace {
+struct Position
+{
+  int x;
+};
+struct Velocity
+{
+  int x;
+};
+struct Health
+{
+  int value;
+};
+
+// Check that the group's entities are packed at the front of both arrays in the same order.
+void CheckGroupInvariant(ComponentManager& comp_manager, Group<Position, Velocity>& group)
+{
+  auto view = comp_manager.GetView<Position, Velocity>();
+  REQUIRE(view.Good());
+  size_t count = 0;
+  view->Each([&](EntityID, Position&, Velocity&) { ++count; });
+  REQUIRE_EQ(group.Size(), count);
+  group.Each([&](EntityID entity_id, Position& position, Velocity& velocity) {
+    REQUIRE_EQ(&position, *comp_manager.GetComponent<Position>(entity_id));
+    REQUIRE_EQ(&velocity, *comp_manager.GetComponent<Velocity>(entity_id));
+    REQUIRE_EQ(static_cast<size_t>(position.x), entity_id.Get());
+    REQUIRE_EQ(static_cast<size_t>(velocity.x), entity_id.Get());
+  });
+}
+}// namespace
+
+TEST_CASE("Test Group")
+{
+  ComponentManager comp_manager;
+  REQUIRE(comp_manager.RegisterComponent<Position>());
+  REQUIRE(comp_manager.RegisterComponent<Velocity>());
+  REQUIRE(comp_manager.RegisterComponent<Health>());
+
+  // Add some entities before the group exists
+  for (size_t i = 0; i < 10; ++i) {
+    REQUIRE(comp_manager.AddComponent(EntityID{ i }, Position{ static_cast<int>(i) }));
+    if (i % 2 == 0) {
+      REQUIRE(comp_manager.AddComponent(EntityID{ i }, Velocity{ static_cast<int>(i) }));
+    }
+  }
+
+  auto group = comp_manager.RegisterGroup<Position, Velocity>();
+  REQUIRE(group.Good());
+  REQUIRE_EQ((*group)->Size(), 5);
+  CheckGroupInvariant(comp_manager, **group);
+
+  // An array can only be owned by one group
+  REQUIRE(comp_manager.RegisterGroup<Velocity, Health>().Bad());
+
+  // Entities joining the group
+  for (size_t i = 10; i < 20; ++i) {
+    REQUIRE(comp_manager.AddComponent(EntityID{ i }, Velocity{ static_cast<int>(i) }));
+    REQUIRE(comp_manager.AddComponent(EntityID{ i }, Position{ static_cast<int>(i) }));
+  }
+  REQUIRE_EQ((*group)->Size(), 15);
+  CheckGroupInvariant(comp_manager, **group);
+
+  // Entities leaving the group
+  REQUIRE(comp_manager.RemoveComponent<Velocity>(EntityID{ 0 }));
+  REQUIRE(comp_manager.RemoveComponent<Position>(EntityID{ 12 }));
+  comp_manager.EntityDestroyed(EntityID{ 15 });
+  // Removing a component from an entity outside the group shouldn't change it
+  REQUIRE(comp_manager.RemoveComponent<Position>(EntityID{ 1 }));
+  REQUIRE_EQ((*group)->Size(), 12);
+  CheckGroupInvariant(comp_manager, **group);
+
+  size_t count = 0;
+  (*group)->Each([&](EntityID, Position& position, Velocity& velocity) {
+    position.x += velocity.x;
+    ++count;
+  });
+  REQUIRE_EQ(count, 12);
+  REQUIRE_EQ((*comp_manager.GetComponent<Position>(EntityID{ 2 }))->x, 4);
+}
+
+TEST_CASE("Test Group change ticks")
+{
+  ComponentManager comp_manager;
+  REQUIRE(comp_manager.RegisterComponent<Position>());
+  REQUIRE(comp_manager.RegisterComponent<Velocity>());
+  auto group = comp_manager.RegisterGroup<const Position, Velocity>();
+  REQUIRE(group.Good());
+  for (size_t i = 0; i < 10; ++i) {
+    REQUIRE(comp_manager.AddComponent(EntityID{ i }, Position{ static_cast<int>(i) }));
+    REQUIRE(comp_manager.AddComponent(EntityID{ i }, Velocity{ 0 }));
+  }
+  const uint32_t since = comp_manager.CurrentTick();
+  comp_manager.AdvanceTick();
+
+  // Only the components that aren't const count as changed.
+  (*group)->Each([](EntityID, const Position& position, Velocity& velocity) { velocity.x = position.x; });
+  auto view = comp_manager.GetView<const Position, const Velocity>();
+  REQUIRE(view.Good());
+  size_t positions = 0;
+  REQUIRE(view->Each<Changed<Position>>(since, [&](EntityID, const Position&, const Velocity&) { ++positions; }));
+  size_t velocities = 0;
+  REQUIRE(view->Each<Changed<Velocity>>(since, [&](EntityID, const Position&, const Velocity&) { ++velocities; }));
+  REQUIRE_EQ(positions, 0);
+  REQUIRE_EQ(velocities, 10);
+}
+
+TEST_CASE("Test Group with archetype storage")
+{
+  ComponentManager comp_manager(StorageMode::Archetype);
+  REQUIRE(comp_manager.RegisterComponent<Position>());
+  REQUIRE(comp_manager.RegisterComponent<Velocity>());
+  REQUIRE(comp_manager.RegisterGroup<Position, Velocity>().Bad());
+}
+
+TEST_CASE("Test Group with a tag component")
+{
+  struct Frozen
+  {
+  };
+  ComponentManager comp_manager;
+  REQUIRE(comp_manager.RegisterComponent<Position>());
+  REQUIRE(comp_manager.RegisterComponent<Frozen>());
+  auto group = comp_manager.RegisterGroup<Position, Frozen>();
+  REQUIRE(group.Good());
+  for (size_t i = 0; i < 10; ++i) {
+    REQUIRE(comp_manager.AddComponent(EntityID{ i }, Position{ static_cast<int>(i) }));
+    if (i % 3 == 0) {
+      REQUIRE(comp_manager.AddComponent(EntityID{ i }, Frozen{}));
+    }
+  }
+  REQUIRE_EQ((*group)->Size(), 4);
+  size_t count = 0;
+  (*group)->Each([&count](EntityID entity_id, Position& position, Frozen&) {
+    REQUIRE_EQ(static_cast<size_t>(position.x), entity_id.Get());
+    REQUIRE_EQ(entity_id.Get() % 3, 0);
+    ++count;
+  });
+  REQUIRE_EQ(count, 4);
+}
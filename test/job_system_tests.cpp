@@ -0,0 +1,154 @@
+#include <doctest/doctest.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "ecs/job_system.hpp"
+#include "ecs/work_stealing_deque.hpp"
+
+TEST_CASE("Test WorkStealingDeque")
+{
+  WorkStealingDeque<int, 4> deque;
+  int items[5]{ 0, 1, 2, 3, 4 };
+  REQUIRE_EQ(deque.Pop(), nullptr);
+  REQUIRE_EQ(deque.Steal(), nullptr);
+  for (int i = 0; i < 4; ++i) {
+    REQUIRE(deque.Push(&items[i]));
+  }
+  // Full
+  REQUIRE_FALSE(deque.Push(&items[4]));
+  REQUIRE_EQ(deque.SizeEstimate(), 4);
+  // The owner pops the newest item and thieves take the oldest.
+  REQUIRE_EQ(deque.Pop(), &items[3]);
+  REQUIRE_EQ(deque.Steal(), &items[0]);
+  REQUIRE_EQ(deque.Steal(), &items[1]);
+  REQUIRE_EQ(deque.Pop(), &items[2]);
+  REQUIRE_EQ(deque.Pop(), nullptr);
+  REQUIRE_EQ(deque.Steal(), nullptr);
+  // Wrapping around the buffer.
+  REQUIRE(deque.Push(&items[4]));
+  REQUIRE_EQ(deque.Steal(), &items[4]);
+}
+
+TEST_CASE("Test JobSystem spawn and wait")
+{
+  JobSystem job_system(3);
+  REQUIRE_EQ(job_system.ThreadCount(), 4);
+  std::atomic<int> count{ 0 };
+  JobCounter counter;
+  REQUIRE(counter.Done());
+  for (int i = 0; i < 1000; ++i) {
+    job_system.Spawn([&count] { count.fetch_add(1); }, &counter);
+  }
+  job_system.WaitHelping(counter);
+  REQUIRE(counter.Done());
+  REQUIRE_EQ(count.load(), 1000);
+
+  // Jobs spawning and waiting on more jobs.
+  JobCounter outer;
+  for (int i = 0; i < 8; ++i) {
+    job_system.Spawn(
+      [&job_system, &count] {
+        JobCounter inner;
+        for (int j = 0; j < 10; ++j) {
+          job_system.Spawn([&count] { count.fetch_add(1); }, &inner);
+        }
+        job_system.WaitHelping(inner);
+      },
+      &outer);
+  }
+  job_system.WaitHelping(outer);
+  REQUIRE_EQ(count.load(), 1080);
+}
+
+TEST_CASE("Test JobSystem dependencies")
+{
+  JobSystem job_system(3);
+  std::atomic<int> first_done{ 0 };
+  std::atomic<bool> ordered{ true };
+  JobCounter first;
+  JobCounter second;
+  for (int i = 0; i < 50; ++i) {
+    job_system.Spawn(
+      [&first_done] {
+        std::this_thread::yield();
+        first_done.fetch_add(1);
+      },
+      &first);
+  }
+  for (int i = 0; i < 50; ++i) {
+    job_system.SpawnAfter(
+      first,
+      [&first_done, &ordered] {
+        if (first_done.load() != 50) {
+          ordered = false;
+        }
+      },
+      &second);
+  }
+  job_system.WaitHelping(second);
+  REQUIRE(first.Done());
+  REQUIRE(ordered.load());
+
+  // A job spawned after a finished counter runs straight away.
+  bool ran = false;
+  JobCounter after;
+  job_system.SpawnAfter(first, [&ran] { ran = true; }, &after);
+  job_system.WaitHelping(after);
+  REQUIRE(ran);
+}
+
+TEST_CASE("Test JobSystem ParallelFor")
+{
+  JobSystem job_system(3);
+  std::vector<int> values(10000, 1);
+  job_system.ParallelForChunks(values.size(), 64, [&values](size_t begin, size_t end) {
+    for (size_t index = begin; index < end; ++index) {
+      values[index] *= 2;
+    }
+  });
+  for (const auto value : values) {
+    REQUIRE_EQ(value, 2);
+  }
+
+  // Nested loops, and per thread scratch.
+  PerThread<int> counts(job_system);
+  job_system.ParallelFor(8, [&](size_t) { job_system.ParallelFor(8, [&](size_t) { ++counts.Local(); }); });
+  int total = 0;
+  counts.ForEach([&total](int count) { total += count; });
+  REQUIRE_EQ(total, 64);
+
+  // Threads outside the job system can still spawn and wait.
+  std::atomic<int> count{ 0 };
+  std::thread outside([&] {
+    JobCounter counter;
+    for (int i = 0; i < 100; ++i) {
+      job_system.Spawn([&count] { count.fetch_add(1); }, &counter);
+    }
+    job_system.WaitHelping(counter);
+    // They don't share the creating thread's slot.
+    REQUIRE_EQ(JobSystem::CurrentThreadIndex(), JobSystem::NOT_A_JOB_THREAD);
+  });
+  outside.join();
+  REQUIRE_EQ(count.load(), 100);
+  REQUIRE_EQ(JobSystem::CurrentThreadIndex(), 0);
+
+  // Every worker has its own slot.
+  PerThread<std::atomic<bool>> seen(job_system);
+  job_system.ParallelFor(64, [&](size_t) {
+    REQUIRE(JobSystem::CurrentThreadIndex() < job_system.ThreadCount());
+    seen.Local().store(true);
+  });
+}
+
+TEST_CASE("Test JobSystem without workers")
+{
+  JobSystem job_system(0);
+  int count = 0;
+  JobCounter counter;
+  job_system.Spawn([&count] { ++count; }, &counter);
+  REQUIRE(counter.Done());
+  job_system.ParallelFor(10, [&count](size_t) { ++count; });
+  REQUIRE_EQ(count, 11);
+}
@@ -117,3 +117,284 @@ TEST_CASE("Test system manager")
   REQUIRE_EQ(system_4.GetEntities().size(), 5);
   REQUIRE_EQ(system_5.GetEntities().size(), 1);
 }
+
+TEST_CASE("Test system manager additional entity sets")
+{
+  struct ExtraSetSystem : public System
+  {
+    void Update(const float& delta_time) override { std::ignore = delta_time; }
+  };
+  struct ExtraComponent1
+  {
+  };
+  struct ExtraComponent2
+  {
+  };
+  struct ExtraComponent3
+  {
+  };
+  EntityManager ent_man;
+  ComponentManager comp_man;
+  REQUIRE(comp_man.RegisterComponent<ExtraComponent1>());
+  REQUIRE(comp_man.RegisterComponent<ExtraComponent2>());
+  REQUIRE(comp_man.RegisterComponent<ExtraComponent3>());
+  SystemManager sys_man(&comp_man, &ent_man);
+
+  SystemSignature main_signature;
+  main_signature.SetComponent<ExtraComponent1>();
+  auto sys_id = sys_man.RegisterSystem<ExtraSetSystem>(main_signature);
+  auto& system = sys_man.GetSystem(sys_id);
+  SystemSignature extra_signature;
+  extra_signature.SetComponent<ExtraComponent2, ExtraComponent3>();
+  auto extra_set = system.RegisterSystemSignature(extra_signature);
+  REQUIRE(extra_set.Good());
+
+  auto ent_id = ent_man.CreateEntity();
+  REQUIRE(ent_id.Good());
+  SystemSignature entity_signature;
+  entity_signature.SetComponent<ExtraComponent1, ExtraComponent2>();
+  sys_man.EntitySignatureChanged(*ent_id, entity_signature);
+  REQUIRE_EQ(system.GetEntities().size(), 1);
+  REQUIRE_EQ((*extra_set)->size(), 0);
+
+  entity_signature.SetComponent<ExtraComponent3>();
+  sys_man.EntitySignatureChanged(*ent_id, entity_signature);
+  REQUIRE_EQ(system.GetEntities().size(), 1);
+  REQUIRE_EQ((*extra_set)->size(), 1);
+
+  entity_signature.ResetComponent<ExtraComponent1>();
+  sys_man.EntitySignatureChanged(*ent_id, entity_signature);
+  REQUIRE_EQ(system.GetEntities().size(), 0);
+  REQUIRE_EQ((*extra_set)->size(), 1);
+
+  sys_man.EntityDestroyed(*ent_id);
+  REQUIRE_EQ((*extra_set)->size(), 0);
+}
+
+namespace {
+struct CounterComponent1
+{
+  int count{ 0 };
+};
+struct CounterComponent2
+{
+  int count{ 0 };
+};
+// Increments its component on every entity and records a destroy for entities that reach 2.
+template<typename ComponentName> struct CounterSystem : public System
+{
+  void Update(const float& delta_time) override
+  {
+    std::ignore = delta_time;
+    for (const auto& entity : GetEntities()) {
+      auto component = entity.GetComponentMut<ComponentName>();
+      if (++(*component)->count == 2) {
+        MarkEntityForDeletion(entity);
+      }
+    }
+  }
+};
+}// namespace
+
+TEST_CASE("Test system manager parallel update")
+{
+  EntityManager ent_man;
+  ComponentManager comp_man;
+  REQUIRE(comp_man.RegisterComponent<CounterComponent1>());
+  REQUIRE(comp_man.RegisterComponent<CounterComponent2>());
+  SystemManager sys_man(&comp_man, &ent_man);
+  JobSystem job_system(3);
+
+  SystemSignature signature_1;
+  signature_1.SetComponent<CounterComponent1>();
+  SystemSignature signature_2;
+  signature_2.SetComponent<CounterComponent2>();
+  auto sys_id_1 = sys_man.RegisterSystem<CounterSystem<CounterComponent1>>(signature_1);
+  auto sys_id_2 = sys_man.RegisterSystem<CounterSystem<CounterComponent2>>(signature_2);
+  // Disjoint signatures can run together.
+  REQUIRE_EQ(sys_man.ScheduleStageCount(), 1);
+  // Systems writing the same component run one after the other.
+  std::ignore = sys_man.RegisterSystem<CounterSystem<CounterComponent1>>(signature_1);
+  REQUIRE_EQ(sys_man.ScheduleStageCount(), 2);
+  // A system reading a component another writes runs after it, and before a later system that writes it.
+  sys_man.SetSystemAccess(sys_id_2, SystemAccess{}.Write<CounterComponent2>().Read<CounterComponent1>());
+  REQUIRE_EQ(sys_man.ScheduleStageCount(), 3);
+  sys_man.SetSystemAccess(sys_id_2, SystemAccess{}.Write<CounterComponent2>());
+  REQUIRE_EQ(sys_man.ScheduleStageCount(), 2);
+  // Resources conflict the same way as components.
+  struct Clock
+  {
+    int frame;
+  };
+  REQUIRE_FALSE(SystemAccess{}.ReadResource<Clock>().ConflictsWith(SystemAccess{}.ReadResource<Clock>()));
+  REQUIRE(SystemAccess{}.ReadResource<Clock>().ConflictsWith(SystemAccess{}.WriteResource<Clock>()));
+  REQUIRE(SystemAccess{}.WriteResource<Clock>().ConflictsWith(SystemAccess{}.WriteResource<Clock>()));
+  // The disjoint systems now share a resource one of them writes so they can't run together.
+  sys_man.SetSystemAccess(sys_id_1, SystemAccess{}.Write<CounterComponent1>().ReadResource<Clock>());
+  sys_man.SetSystemAccess(sys_id_2, SystemAccess{}.Write<CounterComponent2>().WriteResource<Clock>());
+  REQUIRE(sys_man.GetSystem(sys_id_1).GetAccess().ConflictsWith(sys_man.GetSystem(sys_id_2).GetAccess()));
+  sys_man.SetSystemAccess(sys_id_1, SystemAccess{}.Write<CounterComponent1>());
+  sys_man.SetSystemAccess(sys_id_2, SystemAccess{}.Write<CounterComponent2>());
+  REQUIRE_EQ(sys_man.ScheduleStageCount(), 2);
+
+  for (int index = 0; index < 100; ++index) {
+    auto ent_id = ent_man.CreateEntity();
+    REQUIRE(ent_id.Good());
+    SystemSignature entity_signature;
+    if (index % 2 == 0) {
+      REQUIRE(comp_man.AddComponent<CounterComponent1>(*ent_id, {}));
+      entity_signature.SetComponent<CounterComponent1>();
+    } else {
+      REQUIRE(comp_man.AddComponent<CounterComponent2>(*ent_id, {}));
+      entity_signature.SetComponent<CounterComponent2>();
+    }
+    sys_man.EntitySignatureChanged(*ent_id, entity_signature);
+  }
+  sys_man.UpdateSystems(0.0F, job_system);
+  // The two systems on CounterComponent1 both ran so those entities were destroyed.
+  REQUIRE_EQ(sys_man.GetSystem(sys_id_1).GetEntities().size(), 0);
+  REQUIRE_EQ(sys_man.GetSystem(sys_id_2).GetEntities().size(), 50);
+  REQUIRE_EQ(ent_man.EntityCount(), 50);
+  sys_man.UpdateSystems(0.0F, job_system);
+  REQUIRE_EQ(sys_man.GetSystem(sys_id_2).GetEntities().size(), 0);
+  REQUIRE_EQ(ent_man.EntityCount(), 0);
+}
+
+TEST_CASE("Test entity signature table")
+{
+  EntitySignatureTable table;
+  REQUIRE(table.Row(10).empty());
+  REQUIRE_FALSE(table.Test(10, 3));
+
+  table.Set(10, 3);
+  REQUIRE(table.Test(10, 3));
+  REQUIRE_FALSE(table.Test(9, 3));
+  REQUIRE_EQ(table.WordsPerEntity(), 1);
+
+  // A component id past the first word widens every row and keeps the bits already set.
+  table.Set(4, 70);
+  REQUIRE_EQ(table.WordsPerEntity(), 2);
+  REQUIRE(table.Test(10, 3));
+  REQUIRE(table.Test(4, 70));
+
+  SystemSignature wanted;
+  wanted.Set(3);
+  REQUIRE(wanted.IsSubsetOf(table.Row(10)));
+  REQUIRE_FALSE(wanted.IsSubsetOf(table.Row(4)));
+
+  table.Reset(10, 3);
+  REQUIRE_FALSE(table.Test(10, 3));
+  table.Assign(10, wanted);
+  REQUIRE(table.GetSignature(10) == wanted);
+  table.Clear(10);
+  REQUIRE(table.GetSignature(10).Empty());
+}
+
+TEST_CASE("Test system manager change ticks")
+{
+  struct Counter
+  {
+    int value;
+  };
+  // Counts the counters changed since the system last ran and bumps every counter it visits.
+  struct ChangeSystem : public System
+  {
+    size_t changed{ 0 };
+    void Update(const float& /*delta_time*/) override
+    {
+      changed = 0;
+      auto view = GetView<Counter>();
+      REQUIRE(view.Good());
+      view->Each<Changed<Counter>>(LastRunTick(), [this](EntityID, Counter& counter) {
+        ++counter.value;
+        ++changed;
+      });
+    }
+  };
+
+  EntityManager ent_man;
+  ComponentManager comp_man;
+  REQUIRE(comp_man.RegisterComponent<Counter>());
+  SystemManager sys_man(&comp_man, &ent_man);
+  SystemSignature signature;
+  signature.SetComponent<Counter>();
+  auto sys_id = sys_man.RegisterSystem<ChangeSystem>(signature);
+  auto& system = sys_man.GetSystem(sys_id);
+  for (size_t index = 0; index < 10; ++index) {
+    auto ent_id = ent_man.CreateEntity();
+    REQUIRE(ent_id.Good());
+    REQUIRE(comp_man.AddComponent<Counter>(*ent_id, { 0 }));
+  }
+
+  // The first update sees every component, later ones don't see the system's own changes.
+  system.UpdateSystem(0.0F);
+  REQUIRE_EQ(system.changed, 10);
+  system.UpdateSystem(0.0F);
+  REQUIRE_EQ(system.changed, 0);
+
+  // Changes made between updates are seen once.
+  const auto entities = *comp_man.GetComponentEntities<Counter>();
+  REQUIRE(comp_man.GetComponentMut<Counter>(entities[2]));
+  REQUIRE(comp_man.GetComponentMut<Counter>(entities[7]));
+  // Reads aren't changes.
+  REQUIRE(comp_man.GetComponent<Counter>(entities[4]));
+  JobSystem job_system(2);
+  sys_man.UpdateSystems(0.0F, job_system);
+  REQUIRE_EQ(system.changed, 2);
+  sys_man.UpdateSystems(0.0F, job_system);
+  REQUIRE_EQ(system.changed, 0);
+}
+
+TEST_CASE("Test system manager read only systems share a stage")
+{
+  struct Reading
+  {
+    int value;
+  };
+  // Sums its entities' components through GetComponent(), which must not write anything.
+  struct ReadSystem : public System
+  {
+    int64_t sum{ 0 };
+    void Update(const float& /*delta_time*/) override
+    {
+      sum = 0;
+      for (const auto& entity : GetEntities()) {
+        sum += (*entity.GetComponent<Reading>())->value;
+      }
+    }
+  };
+
+  EntityManager ent_man;
+  ComponentManager comp_man;
+  REQUIRE(comp_man.RegisterComponent<Reading>());
+  SystemManager sys_man(&comp_man, &ent_man);
+  JobSystem job_system(3);
+  SystemSignature signature;
+  signature.SetComponent<Reading>();
+  auto reader_1 = sys_man.RegisterSystem<ReadSystem>(signature);
+  auto reader_2 = sys_man.RegisterSystem<ReadSystem>(signature);
+  sys_man.SetSystemAccess(reader_1, SystemAccess{}.Read<Reading>());
+  sys_man.SetSystemAccess(reader_2, SystemAccess{}.Read<Reading>());
+  REQUIRE_EQ(sys_man.ScheduleStageCount(), 1);
+
+  for (int index = 0; index < 1000; ++index) {
+    auto ent_id = ent_man.CreateEntity();
+    REQUIRE(ent_id.Good());
+    REQUIRE(comp_man.AddComponent<Reading>(*ent_id, { index }));
+    sys_man.EntitySignatureChanged(*ent_id, signature);
+  }
+  const uint32_t before_updates = comp_man.CurrentTick();
+  for (int update = 0; update < 10; ++update) {
+    sys_man.UpdateSystems(0.0F, job_system);
+  }
+  REQUIRE_EQ(sys_man.GetSystem(reader_1).sum, 999 * 1000 / 2);
+  REQUIRE_EQ(sys_man.GetSystem(reader_2).sum, 999 * 1000 / 2);
+  // Nothing was written so nothing is marked changed since before the updates.
+  const auto changed = *comp_man.GetComponentEntities<Reading>();
+  size_t changed_count = 0;
+  auto view = comp_man.GetView<const Reading>();
+  REQUIRE(view.Good());
+  view->Each<Changed<Reading>>(before_updates, [&changed_count](EntityID, const Reading&) { ++changed_count; });
+  REQUIRE_EQ(changed.size(), 1000);
+  REQUIRE_EQ(changed_count, 0);
+}
@@ -0,0 +1,248 @@
+#include <doctest/doctest.h>
+
+#include "ecs/component_manager.hpp"
+#include "ecs/view.hpp"
+#include "ids.hpp"
+
+namespace {
+struct Position
+{
+  int x;
+};
+struct Velocity
+{
+  int x;
+};
+struct Health
+{
+  int value;
+};
+
+void PopulateComponents(ComponentManager& comp_manager)
+{
+  REQUIRE(comp_manager.RegisterComponent<Position>());
+  REQUIRE(comp_manager.RegisterComponent<Velocity>());
+  REQUIRE(comp_manager.RegisterComponent<Health>());
+  // Every entity has a Position, every second entity a Velocity and every third a Health.
+  for (size_t i = 0; i < 30; ++i) {
+    REQUIRE(comp_manager.AddComponent(EntityID{ i }, Position{ static_cast<int>(i) }));
+    if (i % 2 == 0) {
+      REQUIRE(comp_manager.AddComponent(EntityID{ i }, Velocity{ 1 }));
+    }
+    if (i % 3 == 0) {
+      REQUIRE(comp_manager.AddComponent(EntityID{ i }, Health{ static_cast<int>(i) }));
+    }
+  }
+}
+
+void CheckView(ComponentManager& comp_manager)
+{
+  auto view = comp_manager.GetView<Position, Velocity, Health>();
+  REQUIRE(view.Good());
+  REQUIRE_EQ(view->SizeHint(), 10);
+  size_t count = 0;
+  view->Each([&](EntityID entity_id, Position& position, Velocity& velocity, Health& health) {
+    REQUIRE_EQ(entity_id.Get() % 6, 0);
+    REQUIRE_EQ(position.x, health.value);
+    position.x += velocity.x;
+    ++count;
+  });
+  REQUIRE_EQ(count, 5);
+  REQUIRE_EQ((*comp_manager.GetComponent<Position>(EntityID{ 6 }))->x, 7);
+  REQUIRE_EQ((*comp_manager.GetComponent<Position>(EntityID{ 3 }))->x, 3);
+
+  auto single_view = comp_manager.GetView<Velocity>();
+  REQUIRE(single_view.Good());
+  count = 0;
+  single_view->Each([&](EntityID, Velocity&) { ++count; });
+  REQUIRE_EQ(count, 15);
+}
+
+void CheckParallelView(ComponentManager& comp_manager)
+{
+  REQUIRE(comp_manager.RegisterComponent<Position>());
+  REQUIRE(comp_manager.RegisterComponent<Velocity>());
+  constexpr size_t entity_count = 5000;
+  for (size_t i = 0; i < entity_count; ++i) {
+    REQUIRE(comp_manager.AddComponent(EntityID{ i }, Position{ static_cast<int>(i) }));
+    if (i % 2 == 0) {
+      REQUIRE(comp_manager.AddComponent(EntityID{ i }, Velocity{ 1 }));
+    }
+  }
+  JobSystem job_system(3);
+  PerThread<size_t> counts(job_system);
+  auto view = comp_manager.GetView<Position, Velocity>();
+  REQUIRE(view.Good());
+  view->ParallelEach(
+    &job_system,
+    [&](EntityID entity_id, Position& position, Velocity& velocity) {
+      REQUIRE_EQ(static_cast<size_t>(position.x), entity_id.Get());
+      position.x += velocity.x;
+      ++counts.Local();
+    },
+    64);
+  size_t count = 0;
+  counts.ForEach([&count](size_t thread_count) { count += thread_count; });
+  REQUIRE_EQ(count, entity_count / 2);
+  REQUIRE_EQ((*comp_manager.GetComponent<Position>(EntityID{ 4000 }))->x, 4001);
+  REQUIRE_EQ((*comp_manager.GetComponent<Position>(EntityID{ 4001 }))->x, 4001);
+
+  // Without a thread pool everything runs on the calling thread.
+  count = 0;
+  view->ParallelEach(nullptr, [&count](EntityID, Position&, Velocity&) { ++count; });
+  REQUIRE_EQ(count, entity_count / 2);
+}
+}// namespace
+
+TEST_CASE("Test View")
+{
+  ComponentManager comp_manager;
+  PopulateComponents(comp_manager);
+  CheckView(comp_manager);
+}
+
+TEST_CASE("Test View with archetype storage")
+{
+  ComponentManager comp_manager(StorageMode::Archetype);
+  PopulateComponents(comp_manager);
+  CheckView(comp_manager);
+}
+
+TEST_CASE("Test View ParallelEach")
+{
+  ComponentManager comp_manager;
+  CheckParallelView(comp_manager);
+}
+
+TEST_CASE("Test View ParallelEach with archetype storage")
+{
+  ComponentManager comp_manager(StorageMode::Archetype);
+  CheckParallelView(comp_manager);
+}
+
+TEST_CASE("Test View of unregistered component")
+{
+  struct Unregistered
+  {
+    int a;
+  };
+  ComponentManager comp_manager;
+  REQUIRE(comp_manager.RegisterComponent<Position>());
+  REQUIRE(comp_manager.GetView<Position, Unregistered>().Bad());
+}
+
+TEST_CASE("Test View change filters")
+{
+  ComponentManager comp_manager;
+  REQUIRE(comp_manager.RegisterComponent<Position>());
+  REQUIRE(comp_manager.RegisterComponent<Velocity>());
+  for (size_t index = 0; index < 10; ++index) {
+    REQUIRE(comp_manager.AddComponent<Position>(EntityID{ index }, { 0 }));
+    REQUIRE(comp_manager.AddComponent<Velocity>(EntityID{ index }, { 1 }));
+  }
+  const uint32_t since = comp_manager.CurrentTick();
+  comp_manager.AdvanceTick();
+  const auto count = [](auto& view, uint32_t tick) {
+    size_t visited = 0;
+    view.template Each<Changed<Position>>(tick, [&visited](EntityID, const Position&, const Velocity&) { ++visited; });
+    return visited;
+  };
+
+  // Everything was added before since.
+  auto read_view = comp_manager.GetView<const Position, const Velocity>();
+  REQUIRE(read_view.Good());
+  REQUIRE_EQ(count(*read_view, 0), 10);
+  REQUIRE_EQ(count(*read_view, since), 0);
+
+  // Reading through a const view or GetComponent() doesn't mark anything changed.
+  read_view->Each([](EntityID, const Position&, const Velocity&) {});
+  REQUIRE(comp_manager.GetComponent<Position>(EntityID{ 4 }));
+  REQUIRE_EQ(count(*read_view, since), 0);
+
+  // Mutable access marks only the touched components.
+  REQUIRE(comp_manager.GetComponentMut<Position>(EntityID{ 3 }));
+  REQUIRE_EQ(count(*read_view, since), 1);
+  auto write_view = comp_manager.GetView<Position, const Velocity>();
+  REQUIRE(write_view.Good());
+  write_view->Each<Changed<Position>>(since, [](EntityID entity_id, Position& position, const Velocity& velocity) {
+    REQUIRE_EQ(entity_id.Get(), 3);
+    position.x += velocity.x;
+  });
+  REQUIRE_EQ((*comp_manager.GetComponent<Position>(EntityID{ 3 }))->x, 1);
+
+  // Added only sees new components, replacing one marks it changed but not added.
+  const uint32_t later = comp_manager.CurrentTick();
+  comp_manager.AdvanceTick();
+  REQUIRE(comp_manager.AddComponent<Position>(EntityID{ 20 }, { 0 }));
+  REQUIRE(comp_manager.AddComponent<Velocity>(EntityID{ 20 }, { 0 }));
+  REQUIRE(comp_manager.AddComponent<Position>(EntityID{ 5 }, { 7 }));
+  size_t added = 0;
+  read_view->Each<Added<Position>>(later, [&added](EntityID entity_id, const Position&, const Velocity&) {
+    REQUIRE_EQ(entity_id.Get(), 20);
+    ++added;
+  });
+  REQUIRE_EQ(added, 1);
+  REQUIRE_EQ(count(*read_view, later), 2);
+
+  // Writing through a view marks every visited entity changed, and the ticks follow components that are moved.
+  write_view->Each([](EntityID, Position&, const Velocity&) {});
+  comp_manager.EntityDestroyed(EntityID{ 0 });
+  const uint32_t last = comp_manager.CurrentTick();
+  comp_manager.AdvanceTick();
+  REQUIRE_EQ(count(*read_view, later), 10);
+  REQUIRE(comp_manager.GetComponentMut<Position>(EntityID{ 20 }));
+  REQUIRE_EQ(count(*read_view, last), 1);
+}
+
+TEST_CASE("Test View change filters with archetype storage")
+{
+  ComponentManager comp_manager(StorageMode::Archetype);
+  REQUIRE(comp_manager.RegisterComponent<Position>());
+  REQUIRE(comp_manager.AddComponent<Position>(EntityID{ 1 }, { 0 }));
+  auto view = comp_manager.GetView<const Position>();
+  REQUIRE(view.Good());
+  // Archetype storage doesn't track ticks so the filter is rejected rather than silently passing or failing entities.
+  size_t visited = 0;
+  REQUIRE(view->Each<Changed<Position>>(0, [&visited](EntityID, const Position&) { ++visited; }).Bad());
+  REQUIRE_EQ(visited, 0);
+}
+
+TEST_CASE("Test View with tag components")
+{
+  struct Selected
+  {
+  };
+  for (const auto storage_mode : { StorageMode::Sparse, StorageMode::Archetype }) {
+    ComponentManager comp_manager(storage_mode);
+    REQUIRE(comp_manager.RegisterComponent<Position>());
+    REQUIRE(comp_manager.RegisterComponent<Selected>());
+    for (size_t index = 0; index < 100; ++index) {
+      REQUIRE(comp_manager.AddComponent<Position>(EntityID{ index }, { static_cast<int>(index) }));
+      if (index % 4 == 0) {
+        REQUIRE(comp_manager.AddComponent<Selected>(EntityID{ index }, {}));
+      }
+    }
+    REQUIRE(comp_manager.HasComponent<Selected>(EntityID{ 8 }));
+    REQUIRE_FALSE(comp_manager.HasComponent<Selected>(EntityID{ 9 }));
+    REQUIRE_EQ(*comp_manager.GetComponentCount<Selected>(), 25);
+
+    auto view = comp_manager.GetView<Position, const Selected>();
+    REQUIRE(view.Good());
+    size_t count = 0;
+    view->Each([&count](EntityID entity_id, Position& position, const Selected&) {
+      REQUIRE_EQ(entity_id.Get() % 4, 0);
+      position.x = -1;
+      ++count;
+    });
+    REQUIRE_EQ(count, 25);
+    REQUIRE_EQ((*comp_manager.GetComponent<Position>(EntityID{ 4 }))->x, -1);
+    REQUIRE_EQ((*comp_manager.GetComponent<Position>(EntityID{ 5 }))->x, 5);
+
+    REQUIRE(comp_manager.RemoveComponent<Selected>(EntityID{ 0 }));
+    comp_manager.EntityDestroyed(EntityID{ 4 });
+    REQUIRE_FALSE(comp_manager.HasComponent<Selected>(EntityID{ 0 }));
+    count = 0;
+    view->Each([&count](EntityID, Position&, const Selected&) { ++count; });
+    REQUIRE_EQ(count, 23);
+  }
+}